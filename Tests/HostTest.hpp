@@ -0,0 +1,100 @@
+//
+//  HostTest.hpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef HostTest_hpp
+#define HostTest_hpp
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Minimal checks for the host tests
+ *
+ * Every test is a program of its own that runs its checks and returns non-zero if any of them failed. Benchmarks only
+ * run when the program is given --bench so that a plain run stays fast and its output stable.
+ */
+
+struct HostTest {
+    int checks = 0;
+    int failures = 0;
+    bool benchmark = false;
+
+    HostTest(int argc, char** argv) {
+        for (int i = 1; i < argc; i++)
+            benchmark |= !strcmp(argv[i], "--bench");
+    }
+
+    /* Records the outcome of a check
+     * @passed *true* if the check passed
+     * @expression The checked expression
+     * @file The file the check is in
+     * @line The line the check is on
+     */
+
+    void check(bool passed, const char* expression, const char* file, int line) {
+        checks++;
+
+        if (passed)
+            return;
+
+        failures++;
+        printf("%s:%d: check failed: %s\n", file, line, expression);
+    }
+
+    /* Prints the summary
+     * @name The name of the test
+     *
+     * @return The exit status of the test
+     */
+
+    int finish(const char* name) {
+        printf("%s: %d checks, %d failures\n", name, checks, failures);
+        return failures ? 1 : 0;
+    }
+};
+
+#define HOST_CHECK(test, expression) (test).check((expression), #expression, __FILE__, __LINE__)
+
+/* Deterministic pseudo random numbers so that fuzzed runs can be reproduced */
+
+struct HostRandom {
+    uint64_t state;
+
+    explicit HostRandom(uint64_t seed) : state(seed ? seed : 1) {}
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state >> 32);
+    }
+
+    uint32_t below(uint32_t bound) { return bound ? next() % bound : 0; }
+};
+
+/* Measures the average cost of an operation
+ * @iterations How many times to run the operation
+ * @operation The operation, called with the iteration index
+ *
+ * @return The average time per iteration in nanoseconds
+ */
+
+template <class Operation>
+double hostBenchmark(int iterations, Operation operation) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; i++)
+        operation(i);
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / iterations;
+}
+
+#endif /* HostTest_hpp */
@@ -0,0 +1,22 @@
+//
+//  IOLib.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOLib_h
+#define IOLib_h
+
+/* Host stand-in for the kernel header, only what the tested sources use.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <IOKit/IOTypes.h>
+
+#define IOLog(...) ((void)0)
+
+#endif /* IOLib_h */
@@ -0,0 +1,17 @@
+//
+//  IOMemoryDescriptor.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOMemoryDescriptor_h
+#define IOMemoryDescriptor_h
+
+/* Host stand-in for the kernel header, only what the tested sources use.
+ */
+
+class IOMemoryDescriptor;
+
+#endif /* IOMemoryDescriptor_h */
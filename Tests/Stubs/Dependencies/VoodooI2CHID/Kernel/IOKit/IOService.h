@@ -0,0 +1,42 @@
+//
+//  IOService.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOService_h
+#define IOService_h
+
+/* Host stand-in for the kernel header. The libkern containers are backed by the standard library, which is enough for
+ * the pipeline stages to walk the transducers of a frame.
+ */
+
+#include <vector>
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+
+#define OSDeclareDefaultStructors(className)
+#define OSDynamicCast(type, object) dynamic_cast<type*>(object)
+
+class OSObject {
+ public:
+    virtual ~OSObject() {}
+};
+
+class OSArray : public OSObject {
+ public:
+    static OSArray* withCapacity(unsigned int capacity) { return new OSArray; }
+
+    unsigned int getCount() const { return static_cast<unsigned int>(objects.size()); }
+    OSObject* getObject(unsigned int index) const { return index < objects.size() ? objects[index] : NULL; }
+    bool setObject(OSObject* object) { objects.push_back(object); return true; }
+    void flushCollection() { objects.clear(); }
+
+ private:
+    std::vector<OSObject*> objects;
+};
+
+#endif /* IOService_h */
@@ -0,0 +1,37 @@
+//
+//  IOTypes.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOTypes_h
+#define IOTypes_h
+
+/* Host stand-in for the kernel header, only what the tested sources use.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t UInt8;
+typedef int8_t SInt8;
+typedef uint16_t UInt16;
+typedef int16_t SInt16;
+typedef uint32_t UInt32;
+typedef int32_t SInt32;
+typedef uint64_t UInt64;
+typedef int64_t SInt64;
+
+typedef int IOReturn;
+typedef UInt32 IOOptionBits;
+typedef SInt32 IOFixed;
+typedef UInt64 AbsoluteTime;
+typedef UInt64 IOByteCount;
+
+#define kIOReturnSuccess        0
+#define kIOReturnError          0xe00002bc
+#define kIOReturnBadArgument    0xe00002c2
+
+#endif /* IOTypes_h */
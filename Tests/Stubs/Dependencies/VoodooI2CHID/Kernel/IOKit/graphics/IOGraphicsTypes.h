@@ -0,0 +1,21 @@
+//
+//  IOGraphicsTypes.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOGraphicsTypes_h
+#define IOGraphicsTypes_h
+
+/* Host stand-in for the kernel header, only what the tested sources use.
+ */
+
+enum {
+    kIOFBSwapAxes = 0x00000001,
+    kIOFBInvertX  = 0x00000002,
+    kIOFBInvertY  = 0x00000004
+};
+
+#endif /* IOGraphicsTypes_h */
@@ -0,0 +1,21 @@
+//
+//  IOHIDDevice.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOHIDDevice_h
+#define IOHIDDevice_h
+
+/* Host stand-in for the kernel header, only what the tested sources use.
+ */
+
+enum IOHIDReportType {
+    kIOHIDReportTypeInput = 0,
+    kIOHIDReportTypeOutput,
+    kIOHIDReportTypeFeature
+};
+
+#endif /* IOHIDDevice_h */
@@ -0,0 +1,34 @@
+//
+//  IOHIDElement.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOHIDElement_h
+#define IOHIDElement_h
+
+/* Host stand-in for the kernel header, only what the tested sources use. Tests build the element tree by hand.
+ */
+
+#include <IOKit/IOService.h>
+
+class IOHIDElement : public OSObject {
+ public:
+    UInt32 usage_page = 0;
+    UInt32 usage = 0;
+    UInt32 logical_max = 0;
+    OSArray* children = NULL;
+
+    IOHIDElement(UInt32 page = 0, UInt32 usage = 0, UInt32 logical_max = 0) : usage_page(page), usage(usage), logical_max(logical_max) {}
+
+    bool conformsTo(UInt32 page, UInt32 usage = 0) { return usage_page == page && (!usage || this->usage == usage); }
+
+    UInt32 getUsagePage() { return usage_page; }
+    UInt32 getUsage() { return usage; }
+    UInt32 getLogicalMax() { return logical_max; }
+    OSArray* getChildElements() { return children; }
+};
+
+#endif /* IOHIDElement_h */
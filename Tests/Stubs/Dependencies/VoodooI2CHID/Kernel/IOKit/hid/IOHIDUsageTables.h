@@ -0,0 +1,24 @@
+//
+//  IOHIDUsageTables.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef IOHIDUsageTables_h
+#define IOHIDUsageTables_h
+
+/* Host stand-in for the kernel header, only what the tested sources use.
+ */
+
+enum {
+    kHIDPage_GenericDesktop = 0x01
+};
+
+enum {
+    kHIDUsage_GD_X = 0x30,
+    kHIDUsage_GD_Y = 0x31
+};
+
+#endif /* IOHIDUsageTables_h */
@@ -0,0 +1,35 @@
+//
+//  clock.h
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef clock_h
+#define clock_h
+
+/* Host stand-in for the kernel header. Absolute time is counted in nanoseconds and uptime only moves when a test
+ * moves it, so that recorded traces replay the same way on every run.
+ */
+
+#include <IOKit/IOTypes.h>
+
+inline uint64_t& hostUptime() {
+    static uint64_t uptime = 0;
+    return uptime;
+}
+
+inline void clock_get_uptime(uint64_t* result) {
+    *result = hostUptime();
+}
+
+inline void absolutetime_to_nanoseconds(uint64_t abstime, uint64_t* result) {
+    *result = abstime;
+}
+
+inline void nanoseconds_to_absolutetime(uint64_t nanoseconds, uint64_t* result) {
+    *result = nanoseconds;
+}
+
+#endif /* clock_h */
@@ -0,0 +1,22 @@
+//
+//  MultitouchHelpers.hpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef MultitouchHelpers_hpp
+#define MultitouchHelpers_hpp
+
+/* Host stand-in for the VoodooI2C header, only what the tested sources use.
+ */
+
+#include <IOKit/IOService.h>
+
+struct VoodooI2CMultitouchEvent {
+    OSArray* transducers;
+    UInt8 contact_count;
+};
+
+#endif /* MultitouchHelpers_hpp */
@@ -0,0 +1,25 @@
+//
+//  VoodooI2CDigitiserStylus.hpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CDigitiserStylus_hpp
+#define VoodooI2CDigitiserStylus_hpp
+
+/* Host stand-in for the VoodooI2C header, the stylus switches on top of the transducer values.
+ */
+
+#include "VoodooI2CDigitiserTransducer.hpp"
+
+class VoodooI2CDigitiserStylus : public VoodooI2CDigitiserTransducer {
+ public:
+    DigitiserTransducerButtonState barrel_switch = {};
+    DigitiserTransducerButtonState eraser = {};
+
+    bool invert = false;
+};
+
+#endif /* VoodooI2CDigitiserStylus_hpp */
@@ -0,0 +1,76 @@
+//
+//  VoodooI2CDigitiserTransducer.hpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CDigitiserTransducer_hpp
+#define VoodooI2CDigitiserTransducer_hpp
+
+/* Host stand-in for the VoodooI2C header, the transducer values without the HID element plumbing.
+ */
+
+#include <IOKit/IOService.h>
+#include <IOKit/hid/IOHIDElement.h>
+
+enum DigitiserTransducerType {
+    kDigitiserTransducerStylus = 0x20,
+    kDigitiserTransducerPuck,
+    kDigitiserTransducerFinger
+};
+
+template <typename T>
+struct TransducerUpdatable {
+    struct {
+        T value;
+        AbsoluteTime timestamp;
+    } current, last;
+
+    void update(const T& value, AbsoluteTime timestamp) {
+        last = current;
+        current.value = value;
+        current.timestamp = timestamp;
+    }
+
+    T value() { return current.value; }
+
+    operator bool() { return current.value != 0; }
+};
+
+typedef TransducerUpdatable<UInt32> DigitiserTransducerButtonState;
+typedef TransducerUpdatable<UInt32> DigitiserTransducerAxisState;
+
+class VoodooI2CDigitiserTransducer : public OSObject {
+ public:
+    DigitiserTransducerType type = kDigitiserTransducerFinger;
+    UInt32 id = 0;
+    UInt32 secondary_id = 0;
+    AbsoluteTime timestamp = 0;
+
+    bool in_range = false;
+    bool is_valid = false;
+
+    struct {
+        DigitiserTransducerAxisState x, y, z;
+    } coordinates = {};
+
+    struct {
+        DigitiserTransducerAxisState width, height;
+    } dimensions = {};
+
+    UInt32 logical_max_x = 0;
+    UInt32 logical_max_y = 0;
+    UInt32 logical_max_z = 0;
+
+    DigitiserTransducerButtonState physical_button = {};
+    DigitiserTransducerButtonState tip_switch = {};
+
+    TransducerUpdatable<UInt32> tip_pressure = {};
+    UInt32 pressure_physical_max = 0;
+
+    IOHIDElement* collection = NULL;
+};
+
+#endif /* VoodooI2CDigitiserTransducer_hpp */
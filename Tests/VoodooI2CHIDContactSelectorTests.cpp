@@ -0,0 +1,250 @@
+//
+//  VoodooI2CHIDContactSelectorTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDContactSelector.hpp"
+
+/* Narrows crowded touch screen frames with the contact selector
+ *
+ * A hand resting on a 10-point panel reports fingers and palm blobs together. The selector has to keep the fingers the
+ * engines are following, prefer confident and small contacts over palms, and do so in time linear in the number of
+ * contacts in the frame.
+ */
+
+#define MAXIMUM_CONTACTS 64
+
+struct SelectorFrame {
+    VoodooI2CHIDContactSelector selector;
+    VoodooI2CDigitiserTransducer transducers[MAXIMUM_CONTACTS];
+    OSArray* array;
+    OSArray* selection;
+    VoodooI2CMultitouchEvent event;
+
+    SelectorFrame() {
+        array = OSArray::withCapacity(MAXIMUM_CONTACTS);
+        selection = OSArray::withCapacity(CONTACT_SELECTOR_MAX_CONTACTS);
+
+        for (int i = 0; i < MAXIMUM_CONTACTS; i++) {
+            transducers[i].secondary_id = i;
+            array->setObject(&transducers[i]);
+        }
+
+        rewind(0);
+    }
+
+    ~SelectorFrame() {
+        delete array;
+        delete selection;
+    }
+
+    /* Points the event back at every transducer of the frame
+     * @count The number of contacts in the frame
+     */
+
+    void rewind(UInt8 count) {
+        event.transducers = array;
+        event.contact_count = count;
+    }
+
+    /* Puts a contact on the panel
+     * @index The slot of the contact
+     * @size The width and height of the contact
+     * @confident *true* if the digitiser is confident that the contact is a finger
+     */
+
+    void touch(int index, UInt32 size, bool confident) {
+        VoodooI2CDigitiserTransducer& transducer = transducers[index];
+
+        transducer.type = kDigitiserTransducerFinger;
+        transducer.is_valid = confident;
+        transducer.tip_switch.update(1, 0);
+        transducer.dimensions.width.update(size, 0);
+        transducer.dimensions.height.update(size, 0);
+    }
+
+    bool selected(int index) {
+        for (int i = 0; i < event.contact_count; i++) {
+            if (event.transducers->getObject(i) == &transducers[index])
+                return true;
+        }
+
+        return false;
+    }
+};
+
+static void testRestingHand(HostTest& test) {
+    SelectorFrame frame;
+
+    // Five fingers, a thumb that the digitiser is not sure about, four palm blobs and four stray small blobs
+    for (int i = 0; i < 5; i++)
+        frame.touch(i, 40 + i, true);
+
+    frame.touch(5, 60, false);
+
+    for (int i = 6; i < 10; i++)
+        frame.touch(i, 400 + i, false);
+
+    for (int i = 10; i < 14; i++)
+        frame.touch(i, 20, true);
+
+    frame.rewind(14);
+    HOST_CHECK(test, frame.selector.needsSelection(frame.event));
+
+    frame.selector.select(frame.event, frame.selection);
+
+    HOST_CHECK(test, frame.event.contact_count == CONTACT_SELECTOR_MAX_CONTACTS);
+    HOST_CHECK(test, frame.event.transducers == frame.selection);
+
+    // Every confident contact is kept and the last slot goes to the thumb, which is smaller than any palm
+    bool confident_kept = true;
+
+    for (int i = 0; i < 5; i++)
+        confident_kept &= frame.selected(i);
+
+    for (int i = 10; i < 14; i++)
+        confident_kept &= frame.selected(i);
+
+    HOST_CHECK(test, confident_kept);
+    HOST_CHECK(test, frame.selected(5));
+    HOST_CHECK(test, !frame.selected(6) && !frame.selected(7) && !frame.selected(8) && !frame.selected(9));
+
+    // The selection is ordered from the smallest confident contact down
+    HOST_CHECK(test, frame.event.transducers->getObject(0) == &frame.transducers[10]);
+    HOST_CHECK(test, frame.event.transducers->getObject(4) == &frame.transducers[0]);
+    HOST_CHECK(test, frame.event.transducers->getObject(9) == &frame.transducers[5]);
+
+    // A palm the engines already follow is seen through to its lift ahead of the thumb, but never ahead of a finger
+    frame.selector.forwarded_identifiers = (1U << 7) | (1U << 8);
+    frame.rewind(14);
+    frame.selector.select(frame.event, frame.selection);
+
+    HOST_CHECK(test, frame.selected(7) && !frame.selected(8) && !frame.selected(5));
+    HOST_CHECK(test, frame.selected(0) && frame.selected(13));
+}
+
+static void testFrameContents(HostTest& test) {
+    SelectorFrame frame;
+
+    for (int i = 0; i < 12; i++)
+        frame.touch(i, 50, true);
+
+    // A stylus in the middle of the frame is never forwarded as a contact
+    frame.transducers[3].type = kDigitiserTransducerStylus;
+
+    // Slots past the contact count are left over from earlier frames
+    frame.rewind(11);
+    frame.selector.select(frame.event, frame.selection);
+
+    HOST_CHECK(test, frame.event.contact_count == 10);
+    HOST_CHECK(test, !frame.selected(3) && !frame.selected(11));
+
+    // Equal contacts keep the order the panel reported them in
+    bool ordered = true;
+
+    for (int i = 1; i < frame.event.contact_count; i++) {
+        VoodooI2CDigitiserTransducer* previous = OSDynamicCast(VoodooI2CDigitiserTransducer, frame.event.transducers->getObject(i - 1));
+        VoodooI2CDigitiserTransducer* current = OSDynamicCast(VoodooI2CDigitiserTransducer, frame.event.transducers->getObject(i));
+
+        ordered &= previous->secondary_id < current->secondary_id;
+    }
+
+    HOST_CHECK(test, ordered);
+
+    // A lifting contact loses to touching ones
+    frame.transducers[0].tip_switch.update(0, 0);
+    frame.rewind(12);
+    frame.selector.select(frame.event, frame.selection);
+
+    HOST_CHECK(test, !frame.selected(0) && frame.selected(10) && frame.selected(11));
+
+    // A limit from the Contact Count Maximum narrows the selection further
+    frame.selector.max_contacts = 4;
+    frame.rewind(11);
+    HOST_CHECK(test, frame.selector.needsSelection(frame.event));
+    frame.selector.select(frame.event, frame.selection);
+
+    HOST_CHECK(test, frame.event.contact_count == 4 && frame.selection->getCount() == 4);
+
+    frame.rewind(4);
+    HOST_CHECK(test, !frame.selector.needsSelection(frame.event));
+}
+
+static void testRandomFrames(HostTest& test) {
+    SelectorFrame frame;
+    HostRandom random(46);
+    int wrong_count = 0;
+    int weaker_kept = 0;
+
+    for (int run = 0; run < 20000; run++) {
+        UInt8 count = 1 + random.below(MAXIMUM_CONTACTS);
+
+        for (int i = 0; i < count; i++) {
+            frame.touch(i, random.below(1000), random.below(4) != 0);
+            frame.transducers[i].tip_switch.update(random.below(8) != 0, 0);
+        }
+
+        frame.selector.forwarded_identifiers = random.next();
+        frame.rewind(count);
+        frame.selector.select(frame.event, frame.selection);
+
+        UInt8 expected = count < CONTACT_SELECTOR_MAX_CONTACTS ? count : CONTACT_SELECTOR_MAX_CONTACTS;
+
+        if (frame.event.contact_count != expected)
+            wrong_count++;
+
+        // Nothing that was dropped beats the weakest contact that was kept on confidence
+        bool kept_invalid = false;
+        bool dropped_valid = false;
+
+        for (int i = 0; i < count; i++) {
+            if (frame.selected(i))
+                kept_invalid |= !frame.transducers[i].is_valid;
+            else
+                dropped_valid |= frame.transducers[i].is_valid;
+        }
+
+        if (kept_invalid && dropped_valid)
+            weaker_kept++;
+    }
+
+    HOST_CHECK(test, wrong_count == 0);
+    HOST_CHECK(test, weaker_kept == 0);
+}
+
+static void benchmarkContacts() {
+    HostRandom random(46);
+
+    // The per-frame cost grows with the contact count and the per-contact cost stays flat
+    for (int count = 8; count <= MAXIMUM_CONTACTS; count *= 2) {
+        SelectorFrame frame;
+
+        for (int i = 0; i < count; i++)
+            frame.touch(i, random.below(1000), random.below(4) != 0);
+
+        double ns = hostBenchmark(200000, [&](int iteration) {
+            frame.selector.forwarded_identifiers = iteration;
+            frame.rewind(static_cast<UInt8>(count));
+            frame.selector.select(frame.event, frame.selection);
+        });
+
+        printf("contact selector: %.1f ns per frame of %d contacts, %.2f ns per contact\n", ns, count, ns / count);
+    }
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testRestingHand(test);
+    testFrameContents(test);
+    testRandomFrames(test);
+
+    if (test.benchmark)
+        benchmarkContacts();
+
+    return test.finish("VoodooI2CHIDContactSelectorTests");
+}
@@ -0,0 +1,301 @@
+//
+//  VoodooI2CHIDContactTrackerTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include <math.h>
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDContactTracker.hpp"
+
+/* Replays multi-finger traces from a panel that scrambles its Contact Identifiers through the contact tracker
+ *
+ * Every finger of a trace follows its own path. The panel reports the fingers in a different order every frame and
+ * gives them identifiers that have nothing to do with the finger, so only the tracker can tell them apart. A finger must
+ * keep the identifier the tracker gave it for as long as it stays down.
+ */
+
+#define FRAME_INTERVAL_NS 8333333ULL
+#define TRACE_START_NS    1000000000ULL
+#define MAXIMUM_CONTACTS  10
+#define LOGICAL_MAX       32767
+
+struct Finger {
+    bool down;
+    bool lifting;
+    double centre_x;
+    double centre_y;
+    double phase;
+    UInt32 tracked_identifier;
+    bool has_identifier;
+};
+
+struct TrackerReplay {
+    VoodooI2CHIDContactTracker tracker;
+    VoodooI2CDigitiserTransducer transducers[MAXIMUM_CONTACTS];
+    OSArray* array;
+
+    TrackerReplay() {
+        array = OSArray::withCapacity(MAXIMUM_CONTACTS);
+
+        for (int i = 0; i < MAXIMUM_CONTACTS; i++) {
+            transducers[i].logical_max_x = LOGICAL_MAX;
+            transducers[i].logical_max_y = LOGICAL_MAX;
+            array->setObject(&transducers[i]);
+        }
+
+        tracker.enabled = true;
+        tracker.configure(MAXIMUM_CONTACTS, 0);
+    }
+
+    ~TrackerReplay() {
+        delete array;
+    }
+
+    /* Runs a frame through the tracker
+     * @timestamp The time of the frame
+     * @count The number of contacts in the frame
+     * @x The X coordinates of the contacts, in slot order
+     * @y The Y coordinates of the contacts, in slot order
+     * @tips The tip switches of the contacts, in slot order
+     * @identifiers The Contact Identifiers the panel gave the contacts, in slot order
+     */
+
+    void frame(uint64_t timestamp, UInt8 count, const UInt32* x, const UInt32* y, const bool* tips, const UInt32* identifiers) {
+        for (int i = 0; i < count; i++) {
+            transducers[i].coordinates.x.update(x[i], timestamp);
+            transducers[i].coordinates.y.update(y[i], timestamp);
+            transducers[i].tip_switch.update(tips[i], timestamp);
+            transducers[i].secondary_id = identifiers[i];
+        }
+
+        VoodooI2CHIDInputFrame input;
+        input.timestamp = timestamp;
+        input.report = NULL;
+        input.report_type = kIOHIDReportTypeInput;
+        input.report_id = 0;
+        input.event.transducers = array;
+        input.event.contact_count = count;
+
+        tracker.processFrame(input);
+    }
+};
+
+static void shuffle(HostRandom& random, int* values, int count) {
+    for (int i = count - 1; i > 0; i--) {
+        int j = random.below(i + 1);
+        int swap = values[i];
+        values[i] = values[j];
+        values[j] = swap;
+    }
+}
+
+/* Replays a trace of fingers landing, moving and lifting
+ * @test The test to record the checks in
+ * @frames The number of frames
+ * @seed Seeds the trace
+ */
+
+static void replayScrambledTrace(HostTest& test, int frames, UInt32 seed) {
+    HostRandom random(seed);
+    TrackerReplay replay;
+    Finger fingers[MAXIMUM_CONTACTS] = {};
+
+    // Fingers rest on a grid far enough apart that none can be mistaken for its neighbour
+    for (int i = 0; i < MAXIMUM_CONTACTS; i++) {
+        fingers[i].centre_x = 4000 + (i % 5) * 6000;
+        fingers[i].centre_y = 8000 + (i / 5) * 12000;
+        fingers[i].phase = random.below(628) / 100.0;
+        fingers[i].down = i < 5;
+    }
+
+    int identity_switches = 0;
+    int duplicate_identifiers = 0;
+    int landings = 0;
+
+    for (int frame = 0; frame < frames; frame++) {
+        uint64_t timestamp = TRACE_START_NS + frame * FRAME_INTERVAL_NS;
+
+        // Every so often a finger lands or starts to lift
+        if (frame % 12 == 11) {
+            int finger = random.below(MAXIMUM_CONTACTS);
+
+            if (fingers[finger].down)
+                fingers[finger].lifting = true;
+            else {
+                fingers[finger].down = true;
+                fingers[finger].has_identifier = false;
+                landings++;
+            }
+        }
+
+        int order[MAXIMUM_CONTACTS];
+        int count = 0;
+
+        for (int i = 0; i < MAXIMUM_CONTACTS; i++) {
+            if (fingers[i].down)
+                order[count++] = i;
+        }
+
+        shuffle(random, order, count);
+
+        UInt32 x[MAXIMUM_CONTACTS];
+        UInt32 y[MAXIMUM_CONTACTS];
+        bool tips[MAXIMUM_CONTACTS];
+        UInt32 identifiers[MAXIMUM_CONTACTS];
+
+        for (int slot = 0; slot < count; slot++) {
+            Finger& finger = fingers[order[slot]];
+            double angle = finger.phase + frame * 0.05;
+
+            // Circles of 1500 units, about 75 units a frame
+            x[slot] = static_cast<UInt32>(finger.centre_x + 1500 * cos(angle));
+            y[slot] = static_cast<UInt32>(finger.centre_y + 1500 * sin(angle));
+            tips[slot] = !finger.lifting;
+
+            // The panel hands out identifiers at random, sometimes the same one twice
+            identifiers[slot] = random.below(MAXIMUM_CONTACTS);
+        }
+
+        replay.frame(timestamp, static_cast<UInt8>(count), x, y, tips, identifiers);
+
+        UInt32 seen = 0;
+
+        for (int slot = 0; slot < count; slot++) {
+            Finger& finger = fingers[order[slot]];
+            UInt32 identifier = replay.transducers[slot].secondary_id;
+
+            if (finger.has_identifier && finger.tracked_identifier != identifier)
+                identity_switches++;
+
+            if (seen & (1U << identifier))
+                duplicate_identifiers++;
+
+            seen |= 1U << identifier;
+
+            finger.tracked_identifier = identifier;
+            finger.has_identifier = true;
+
+            if (finger.lifting) {
+                finger.down = false;
+                finger.lifting = false;
+            }
+        }
+    }
+
+    HOST_CHECK(test, landings > 10);
+    HOST_CHECK(test, identity_switches == 0);
+    HOST_CHECK(test, duplicate_identifiers == 0);
+
+    // Scrambled identifiers are all the tracker ever sees, and no contact was beyond the gate
+    HOST_CHECK(test, replay.tracker.identifier_changes > 0);
+    HOST_CHECK(test, replay.tracker.gated_contacts == 0);
+}
+
+static void testIdentifiers(HostTest& test) {
+    TrackerReplay replay;
+    uint64_t timestamp = TRACE_START_NS;
+
+    UInt32 x[3] = {1000, 10000, 20000};
+    UInt32 y[3] = {1000, 1000, 1000};
+    bool tips[3] = {true, true, true};
+    UInt32 identifiers[3] = {7, 7, 7};
+
+    // Contacts are numbered from the lowest free identifier
+    replay.frame(timestamp, 3, x, y, tips, identifiers);
+
+    HOST_CHECK(test, replay.transducers[0].secondary_id == 0);
+    HOST_CHECK(test, replay.transducers[1].secondary_id == 1);
+    HOST_CHECK(test, replay.transducers[2].secondary_id == 2);
+    HOST_CHECK(test, replay.tracker.new_contacts == 3);
+
+    // The middle finger lifts, the others move and swap slots
+    timestamp += FRAME_INTERVAL_NS;
+    UInt32 lift_x[3] = {20100, 10000, 1100};
+    bool lift_tips[3] = {true, false, true};
+    replay.frame(timestamp, 3, lift_x, y, lift_tips, identifiers);
+
+    HOST_CHECK(test, replay.transducers[0].secondary_id == 2);
+    HOST_CHECK(test, replay.transducers[1].secondary_id == 1);
+    HOST_CHECK(test, replay.transducers[2].secondary_id == 0);
+
+    // A finger landing takes the identifier that was freed
+    timestamp += FRAME_INTERVAL_NS;
+    UInt32 land_x[3] = {1200, 15000, 20200};
+    replay.frame(timestamp, 3, land_x, y, tips, identifiers);
+
+    HOST_CHECK(test, replay.transducers[0].secondary_id == 0);
+    HOST_CHECK(test, replay.transducers[1].secondary_id == 1);
+    HOST_CHECK(test, replay.transducers[2].secondary_id == 2);
+    HOST_CHECK(test, replay.tracker.new_contacts == 4);
+    HOST_CHECK(test, replay.tracker.gated_contacts == 0);
+
+    // A contact that jumps further than the gate is a new contact, counted as one the gate rejected, and its old track
+    // is dropped
+    timestamp += FRAME_INTERVAL_NS;
+    UInt32 jump_x[3] = {1300, 15000, 20300};
+    UInt32 jump_y[3] = {1000, 30000, 1000};
+    replay.frame(timestamp, 3, jump_x, jump_y, tips, identifiers);
+
+    HOST_CHECK(test, replay.transducers[0].secondary_id == 0);
+    HOST_CHECK(test, replay.transducers[1].secondary_id == 1);
+    HOST_CHECK(test, replay.transducers[2].secondary_id == 2);
+    HOST_CHECK(test, replay.tracker.new_contacts == 5);
+    HOST_CHECK(test, replay.tracker.gated_contacts == 1);
+
+    // Forgetting every contact makes them all new
+    replay.tracker.reset();
+    timestamp += FRAME_INTERVAL_NS;
+    replay.frame(timestamp, 3, jump_x, jump_y, tips, identifiers);
+
+    HOST_CHECK(test, replay.tracker.new_contacts == 8);
+    HOST_CHECK(test, replay.tracker.gated_contacts == 1);
+}
+
+static void benchmarkContacts() {
+    HostRandom random(34);
+
+    for (int count = 1; count <= MAXIMUM_CONTACTS; count++) {
+        TrackerReplay replay;
+
+        int order[MAXIMUM_CONTACTS];
+        UInt32 x[MAXIMUM_CONTACTS];
+        UInt32 y[MAXIMUM_CONTACTS];
+        bool tips[MAXIMUM_CONTACTS];
+        UInt32 identifiers[MAXIMUM_CONTACTS] = {};
+
+        for (int i = 0; i < count; i++)
+            order[i] = i;
+
+        double ns = hostBenchmark(200000, [&](int frame) {
+            // Fingers bunched up in one corner, so that every contact is within the gate of every track
+            shuffle(random, order, count);
+
+            for (int slot = 0; slot < count; slot++) {
+                x[slot] = 1000 + order[slot] * 300 + frame % 50;
+                y[slot] = 1000 + order[slot] * 200;
+                tips[slot] = true;
+            }
+
+            replay.frame(TRACE_START_NS + frame * FRAME_INTERVAL_NS, static_cast<UInt8>(count), x, y, tips, identifiers);
+        });
+
+        printf("contact tracker: %.1f ns per frame of %d contacts\n", ns, count);
+    }
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testIdentifiers(test);
+    replayScrambledTrace(test, 5000, 34);
+    replayScrambledTrace(test, 5000, 3401);
+
+    if (test.benchmark)
+        benchmarkContacts();
+
+    return test.finish("VoodooI2CHIDContactTrackerTests");
+}
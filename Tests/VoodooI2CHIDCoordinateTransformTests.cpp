@@ -0,0 +1,284 @@
+//
+//  VoodooI2CHIDCoordinateTransformTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDCoordinateTransform.hpp"
+
+#include "../../../Multitouch Support/VoodooI2CDigitiserTransducer.hpp"
+
+/* Checks the fixed point coordinate transform against exact integer arithmetic and against the float conversion and
+ * rotation the touch screen driver used before it
+ */
+
+static const UInt8 rotations[] = {
+    0,
+    kIOFBSwapAxes,
+    kIOFBInvertX,
+    kIOFBInvertY,
+    kIOFBSwapAxes | kIOFBInvertX,
+    kIOFBSwapAxes | kIOFBInvertY,
+    kIOFBInvertX | kIOFBInvertY,
+    kIOFBSwapAxes | kIOFBInvertX | kIOFBInvertY
+};
+
+/* The conversion of checkFingerTouch, checkStylus and scrollPosition before the transform */
+
+static IOFixed floatScale(UInt32 value, UInt32 max) {
+    return ((value * 1.0f) / max) * 65535;
+}
+
+/* checkRotation before the transform */
+
+static void floatRotation(UInt8 rotation, IOFixed* x, IOFixed* y) {
+    if (rotation & kIOFBSwapAxes) {
+        IOFixed old_x = *x;
+        *x = *y;
+        *y = old_x;
+    }
+
+    if (rotation & kIOFBInvertX)
+        *x = 65535 - *x;
+    if (rotation & kIOFBInvertY)
+        *y = 65535 - *y;
+}
+
+static IOFixed exactScale(UInt32 offset, UInt32 range) {
+    return static_cast<IOFixed>((static_cast<uint64_t>(offset) * COORDINATE_TRANSFORM_MAX) / range);
+}
+
+static void testExact(HostTest& test) {
+    VoodooI2CHIDCoordinateTransform transform;
+    HostRandom random(42);
+    UInt32 mismatches = 0;
+
+    // Every range below 65536, every offset of the smaller ones and a stride through the others
+    for (UInt32 range = 1; range < 65536; range++) {
+        UInt32 min_x = range % 7 * 100;
+        UInt32 min_y = range % 3 * 1000;
+        UInt32 stride = range < 4096 ? 1 : 61 + random.below(40);
+
+        transform.configure(min_x, min_x + range, min_y, min_y + range);
+
+        for (UInt32 offset = 0; offset <= range; offset += stride) {
+            IOFixed x, y;
+            transform.apply(min_x + offset, min_y + range - offset, &x, &y);
+
+            if (x != exactScale(offset, range) || y != exactScale(range - offset, range))
+                mismatches++;
+        }
+
+        // The top of the range is never skipped
+        IOFixed x, y;
+        transform.apply(min_x + range, min_y + range, &x, &y);
+
+        if (x != COORDINATE_TRANSFORM_MAX || y != COORDINATE_TRANSFORM_MAX)
+            mismatches++;
+    }
+
+    HOST_CHECK(test, mismatches == 0);
+
+    // A calibrated range clamps everything outside of it
+    transform.configure(100, 900, 200, 1800);
+
+    IOFixed x, y;
+    transform.apply(0, 5000, &x, &y);
+    HOST_CHECK(test, x == 0 && y == COORDINATE_TRANSFORM_MAX);
+
+    transform.apply(500, 1000, &x, &y);
+    HOST_CHECK(test, x == exactScale(400, 800) && y == exactScale(800, 1600));
+
+    // An empty range maps everything to the origin rather than dividing by zero
+    transform.configure(0, 0, 10, 10);
+    transform.apply(1000, 1000, &x, &y);
+    HOST_CHECK(test, x == 0 && y == 0);
+
+    HOST_CHECK(test, VoodooI2CHIDCoordinateTransform::scale(1000, 0) == 0);
+}
+
+static void testFloatPath(HostTest& test) {
+    const UInt32 maxima[][2] = {{4095, 4095}, {9600, 7200}, {32767, 32767}, {65535, 65535}, {2628, 1332}, {1, 65535}};
+    HostRandom random(4201);
+
+    for (size_t i = 0; i < sizeof(maxima) / sizeof(maxima[0]); i++) {
+        UInt32 max_x = maxima[i][0];
+        UInt32 max_y = maxima[i][1];
+
+        for (size_t r = 0; r < sizeof(rotations); r++) {
+            VoodooI2CHIDCoordinateTransform transform;
+            transform.configure(0, max_x, 0, max_y);
+            transform.setRotation(rotations[r]);
+
+            UInt32 differences = 0;
+            UInt32 off_by_more = 0;
+
+            for (int sample = 0; sample < 200000; sample++) {
+                UInt32 value_x = sample < 2 ? sample * max_x : random.below(max_x + 1);
+                UInt32 value_y = sample < 2 ? sample * max_y : random.below(max_y + 1);
+
+                IOFixed old_x = floatScale(value_x, max_x);
+                IOFixed old_y = floatScale(value_y, max_y);
+                floatRotation(rotations[r], &old_x, &old_y);
+
+                IOFixed x, y;
+                transform.apply(value_x, value_y, &x, &y);
+
+                IOFixed difference_x = x > old_x ? x - old_x : old_x - x;
+                IOFixed difference_y = y > old_y ? y - old_y : old_y - y;
+
+                if (difference_x || difference_y)
+                    differences++;
+
+                // Float rounding moves a value by one step at most
+                if (difference_x > 1 || difference_y > 1)
+                    off_by_more++;
+            }
+
+            HOST_CHECK(test, off_by_more == 0);
+
+            // Only values the float path rounded the wrong way differ at all
+            HOST_CHECK(test, differences < 200000 / 100);
+        }
+
+        // The conversions that do not go through the transform
+        UInt32 scale_mismatches = 0;
+
+        for (int sample = 0; sample < 100000; sample++) {
+            UInt32 value = random.below(max_x + 1);
+            IOFixed difference = VoodooI2CHIDCoordinateTransform::scale(value, max_x) - floatScale(value, max_x);
+
+            if (difference < -1 || difference > 1)
+                scale_mismatches++;
+        }
+
+        HOST_CHECK(test, scale_mismatches == 0);
+    }
+}
+
+static void testRotations(HostTest& test) {
+    VoodooI2CHIDCoordinateTransform transform;
+    transform.configure(0, 1000, 0, 2000);
+
+    // The corner at the logical origin ends up where each rotation puts it
+    for (size_t r = 0; r < sizeof(rotations); r++) {
+        transform.setRotation(rotations[r]);
+
+        IOFixed x, y;
+        transform.apply(0, 2000, &x, &y);
+
+        IOFixed expected_x = 0;
+        IOFixed expected_y = COORDINATE_TRANSFORM_MAX;
+        floatRotation(rotations[r], &expected_x, &expected_y);
+
+        HOST_CHECK(test, x == expected_x && y == expected_y);
+    }
+}
+
+static void testFreshTransducer(HostTest& test) {
+    // A finger collection as the HID family builds it, with X and Y amid the other usages
+    IOHIDElement tip(0x0D, 0x42, 1);
+    IOHIDElement x_element(kHIDPage_GenericDesktop, kHIDUsage_GD_X, 4095);
+    IOHIDElement y_element(kHIDPage_GenericDesktop, kHIDUsage_GD_Y, 2047);
+    IOHIDElement collection(0x0D, 0x22);
+
+    collection.children = OSArray::withCapacity(3);
+    collection.children->setObject(&tip);
+    collection.children->setObject(&x_element);
+    collection.children->setObject(&y_element);
+
+    // The driver starts before the first report, so the transducer has not seen a logical maximum yet
+    VoodooI2CDigitiserTransducer transducer;
+    transducer.collection = &collection;
+
+    HOST_CHECK(test, transducer.logical_max_x == 0 && transducer.logical_max_y == 0);
+
+    VoodooI2CHIDCoordinateTransform transform;
+    HOST_CHECK(test, transform.configure(transducer.collection));
+
+    IOFixed x, y;
+    transform.apply(4095, 2047, &x, &y);
+    HOST_CHECK(test, x == COORDINATE_TRANSFORM_MAX && y == COORDINATE_TRANSFORM_MAX);
+
+    transform.apply(0, 0, &x, &y);
+    HOST_CHECK(test, x == 0 && y == 0);
+
+    transform.apply(2048, 1024, &x, &y);
+    HOST_CHECK(test, x == exactScale(2048, 4095) && y == exactScale(1024, 2047));
+
+    // The first report filling in the transducer maxima agrees with the descriptor
+    transducer.logical_max_x = x_element.getLogicalMax();
+    transducer.logical_max_y = y_element.getLogicalMax();
+
+    VoodooI2CHIDCoordinateTransform decoded;
+    decoded.configure(0, transducer.logical_max_x, 0, transducer.logical_max_y);
+
+    IOFixed decoded_x, decoded_y;
+    decoded.apply(1234, 567, &decoded_x, &decoded_y);
+    transform.apply(1234, 567, &x, &y);
+    HOST_CHECK(test, x == decoded_x && y == decoded_y);
+
+    // A collection without both axes leaves the transform as it was
+    collection.children->flushCollection();
+    collection.children->setObject(&x_element);
+
+    HOST_CHECK(test, !transform.configure(&collection));
+    HOST_CHECK(test, !transform.configure(NULL));
+
+    transform.apply(4095, 2047, &x, &y);
+    HOST_CHECK(test, x == COORDINATE_TRANSFORM_MAX && y == COORDINATE_TRANSFORM_MAX);
+
+    delete collection.children;
+}
+
+static void benchmark() {
+    VoodooI2CHIDCoordinateTransform transform;
+    transform.configure(0, 9600, 0, 7200);
+    transform.setRotation(kIOFBSwapAxes | kIOFBInvertY);
+
+    HostRandom random(42);
+    UInt32 values[4096][2];
+
+    for (int i = 0; i < 4096; i++) {
+        values[i][0] = random.below(9601);
+        values[i][1] = random.below(7201);
+    }
+
+    // The float path reads the maxima and rotation from the transducer and the driver, keep them out of the constant folder
+    volatile UInt32 opaque_max_x = 9600;
+    volatile UInt32 opaque_max_y = 7200;
+    volatile UInt8 opaque_rotation = kIOFBSwapAxes | kIOFBInvertY;
+    volatile IOFixed sink = 0;
+
+    double transform_ns = hostBenchmark(10000000, [&](int i) {
+        IOFixed x, y;
+        transform.apply(values[i & 4095][0], values[i & 4095][1], &x, &y);
+        sink = sink + x + y;
+    });
+
+    double float_ns = hostBenchmark(10000000, [&](int i) {
+        IOFixed x = floatScale(values[i & 4095][0], opaque_max_x);
+        IOFixed y = floatScale(values[i & 4095][1], opaque_max_y);
+        floatRotation(opaque_rotation, &x, &y);
+        sink = sink + x + y;
+    });
+
+    printf("coordinate transform: %.2f ns per contact, %.2f ns with float math and rotation\n", transform_ns, float_ns);
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testExact(test);
+    testFloatPath(test);
+    testRotations(test);
+    testFreshTransducer(test);
+
+    if (test.benchmark)
+        benchmark();
+
+    return test.finish("VoodooI2CHIDCoordinateTransformTests");
+}
@@ -0,0 +1,688 @@
+//
+//  VoodooI2CHIDDescriptorTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDCoordinateTransform.hpp"
+
+/* Runs the digitiser element classification over a corpus of real and mutated report descriptors
+ *
+ * The driver walks the IOHIDElement tree that the HID family builds out of the report descriptor, which is not
+ * available on the host. <DescriptorParser> builds the same tree out of the descriptor items and <classifyElements>
+ * repeats the decisions of <VoodooI2CMultitouchHIDEventDriver::parseElements> and
+ * <VoodooI2CMultitouchHIDEventDriver::parseDigitizerElement> on it, with the axes scaled by the driver's own
+ * <VoodooI2CHIDCoordinateTransform::scalePhysicalMax>. The corpus holds the SYNA3602 descriptor, read from its override
+ * so that the two never drift apart, a few hand written ones and fuzzed and inflated copies of all of them.
+ */
+
+#define PAGE_GENERIC_DESKTOP 0x01
+#define PAGE_DIGITIZER       0x0D
+#define PAGE_BUTTON          0x09
+
+#define USAGE_GD_X 0x30
+#define USAGE_GD_Y 0x31
+
+#define USAGE_DIG_PEN                  0x02
+#define USAGE_DIG_TOUCH_SCREEN         0x04
+#define USAGE_DIG_TOUCH_PAD            0x05
+#define USAGE_DIG_DEVICE_CONFIGURATION 0x0E
+#define USAGE_DIG_STYLUS               0x20
+#define USAGE_DIG_FINGER               0x22
+#define USAGE_DIG_DEVICE_MODE          0x52
+#define USAGE_DIG_CONTACT_IDENTIFIER   0x51
+#define USAGE_DIG_CONTACT_COUNT        0x54
+#define USAGE_DIG_CONTACT_COUNT_MAXIMUM 0x55
+#define USAGE_DIG_SCAN_TIME            0x56
+
+enum HostElementType {
+    kHostElementCollection,
+    kHostElementInput,
+    kHostElementOutput,
+    kHostElementFeature
+};
+
+struct HostElement {
+    HostElementType type;
+    UInt32 usage_page;
+    UInt32 usage;
+    UInt32 logical_max;
+    UInt32 physical_max;
+    UInt32 unit_exponent;
+    UInt32 unit;
+    std::vector<size_t> children;
+
+    bool conformsTo(UInt32 page, UInt32 usage) const { return usage_page == page && this->usage == usage; }
+};
+
+/* Builds the element tree of a report descriptor the way the HID family lays it out
+ *
+ * Every collection and every usage of a main item becomes an element, in descriptor order, and the elements of a
+ * collection are its children. Malformed descriptors are parsed as far as they make sense: a truncated item ends the
+ * descriptor and an unbalanced End Collection is ignored.
+ */
+
+struct DescriptorParser {
+    struct Globals {
+        UInt32 usage_page = 0;
+        UInt32 logical_max = 0;
+        UInt32 physical_max = 0;
+        UInt32 unit_exponent = 0;
+        UInt32 unit = 0;
+        UInt32 report_count = 0;
+    };
+
+    std::vector<HostElement> elements;
+
+    void parse(const std::vector<UInt8>& descriptor) {
+        std::vector<Globals> global_stack;
+        std::vector<size_t> collections;
+        std::vector<UInt32> usages;
+        Globals globals;
+        UInt32 usage_min = 0;
+        UInt32 usage_max = 0;
+        bool usage_range = false;
+
+        elements.clear();
+
+        size_t offset = 0;
+
+        while (offset < descriptor.size()) {
+            UInt8 prefix = descriptor[offset++];
+
+            // Long items carry their size in the next byte and have no meaning to us
+            if (prefix == 0xFE) {
+                if (offset + 2 > descriptor.size())
+                    break;
+
+                offset += 2 + descriptor[offset];
+                continue;
+            }
+
+            size_t size = prefix & 0x03;
+            if (size == 3)
+                size = 4;
+
+            if (offset + size > descriptor.size())
+                break;
+
+            UInt32 data = 0;
+            for (size_t i = 0; i < size; i++)
+                data |= static_cast<UInt32>(descriptor[offset + i]) << (8 * i);
+
+            offset += size;
+
+            UInt8 item = prefix & 0xFC;
+
+            switch (item) {
+                // Main items
+                case 0x80:
+                case 0x90:
+                case 0xB0: {
+                    HostElementType type = item == 0x80 ? kHostElementInput : item == 0x90 ? kHostElementOutput : kHostElementFeature;
+
+                    if (usage_range) {
+                        // A range never yields more elements than the report has fields
+                        for (UInt32 usage = usage_min; usage <= usage_max && usage - usage_min < globals.report_count; usage++) {
+                            addElement(collections, type, globals, usage);
+
+                            if (usage == 0xFFFFFFFF)
+                                break;
+                        }
+                    }
+
+                    for (size_t i = 0; i < usages.size(); i++)
+                        addElement(collections, type, globals, usages[i]);
+
+                    usages.clear();
+                    usage_range = false;
+                    break;
+                }
+                case 0xA0: {
+                    size_t collection = addElement(collections, kHostElementCollection, globals, usages.empty() ? 0 : usages[0]);
+                    collections.push_back(collection);
+                    usages.clear();
+                    usage_range = false;
+                    break;
+                }
+                case 0xC0:
+                    if (!collections.empty())
+                        collections.pop_back();
+                    usages.clear();
+                    usage_range = false;
+                    break;
+
+                // Global items
+                case 0x04:
+                    globals.usage_page = data;
+                    break;
+                case 0x24:
+                    globals.logical_max = data;
+                    break;
+                case 0x44:
+                    globals.physical_max = data;
+                    break;
+                case 0x54:
+                    globals.unit_exponent = data;
+                    break;
+                case 0x64:
+                    globals.unit = data;
+                    break;
+                case 0x94:
+                    globals.report_count = data;
+                    break;
+                case 0xA4:
+                    global_stack.push_back(globals);
+                    break;
+                case 0xB4:
+                    if (!global_stack.empty()) {
+                        globals = global_stack.back();
+                        global_stack.pop_back();
+                    }
+                    break;
+
+                // Local items, a four byte usage carries its own page
+                case 0x08:
+                    usages.push_back(size == 4 ? data : (globals.usage_page << 16) | data);
+                    break;
+                case 0x18:
+                    usage_min = size == 4 ? data : (globals.usage_page << 16) | data;
+                    usage_range = true;
+                    break;
+                case 0x28:
+                    usage_max = size == 4 ? data : (globals.usage_page << 16) | data;
+                    usage_range = true;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    size_t addElement(const std::vector<size_t>& collections, HostElementType type, const Globals& globals, UInt32 usage) {
+        HostElement element;
+        element.type = type;
+        element.usage_page = usage >> 16;
+        element.usage = usage & 0xFFFF;
+        element.logical_max = globals.logical_max;
+        element.physical_max = globals.physical_max;
+        element.unit_exponent = globals.unit_exponent;
+        element.unit = globals.unit;
+
+        elements.push_back(element);
+
+        size_t index = elements.size() - 1;
+
+        if (!collections.empty())
+            elements[collections.back()].children.push_back(index);
+
+        return index;
+    }
+};
+
+struct DigitiserLayout {
+    size_t fingers = 0;
+    size_t styluses = 0;
+    size_t contacts_per_report = 0;
+    bool contact_count = false;
+    bool contact_count_maximum = false;
+    UInt32 contact_count_maximum_value = 0;
+    bool scan_time = false;
+    bool input_mode = false;
+    bool button = false;
+    UInt32 logical_max_x = 0;
+    UInt32 logical_max_y = 0;
+    UInt32 physical_max_x = 0;
+    UInt32 physical_max_y = 0;
+    size_t wrappers = 0;
+};
+
+static void classifyDigitiserElement(const DescriptorParser& parser, const HostElement& digitiser, DigitiserLayout& layout) {
+    if (digitiser.conformsTo(PAGE_DIGITIZER, USAGE_DIG_DEVICE_CONFIGURATION)) {
+        for (size_t i = 0; i < digitiser.children.size(); i++) {
+            const HostElement& element = parser.elements[digitiser.children[i]];
+
+            if (!element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_FINGER))
+                continue;
+
+            for (size_t j = 0; j < element.children.size(); j++) {
+                if (parser.elements[element.children[j]].conformsTo(PAGE_DIGITIZER, USAGE_DIG_DEVICE_MODE))
+                    layout.input_mode = true;
+            }
+        }
+
+        return;
+    }
+
+    for (size_t i = 0; i < digitiser.children.size(); i++) {
+        const HostElement& element = parser.elements[digitiser.children[i]];
+
+        if (element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_STYLUS)) {
+            layout.styluses++;
+            continue;
+        }
+
+        if (element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_FINGER)) {
+            layout.fingers++;
+
+            for (size_t j = 0; j < element.children.size(); j++) {
+                const HostElement& sub_element = parser.elements[element.children[j]];
+
+                if (sub_element.conformsTo(PAGE_GENERIC_DESKTOP, USAGE_GD_X) && !layout.logical_max_x) {
+                    layout.logical_max_x = sub_element.logical_max;
+                    layout.physical_max_x = VoodooI2CHIDCoordinateTransform::scalePhysicalMax(sub_element.physical_max, sub_element.unit_exponent, sub_element.unit);
+                } else if (sub_element.conformsTo(PAGE_GENERIC_DESKTOP, USAGE_GD_Y) && !layout.logical_max_y) {
+                    layout.logical_max_y = sub_element.logical_max;
+                    layout.physical_max_y = VoodooI2CHIDCoordinateTransform::scalePhysicalMax(sub_element.physical_max, sub_element.unit_exponent, sub_element.unit);
+                }
+            }
+
+            continue;
+        }
+
+        if (element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_CONTACT_COUNT))
+            layout.contact_count = true;
+        else if (element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_SCAN_TIME))
+            layout.scan_time = true;
+        else if (element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_DEVICE_MODE))
+            layout.input_mode = true;
+        else if (element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_CONTACT_COUNT_MAXIMUM)) {
+            layout.contact_count_maximum = true;
+            // The driver reads the feature report, devices report their logical maximum there
+            layout.contact_count_maximum_value = element.logical_max & 0xFF;
+        } else if (element.conformsTo(PAGE_BUTTON, 1))
+            layout.button = true;
+    }
+}
+
+/* Classifies the elements of a descriptor
+ * @parser The parsed descriptor
+ * @layout The digitiser layout
+ *
+ * @return *false* if the descriptor has no digitiser transducers, the driver refuses to start then
+ */
+
+static bool classifyElements(const DescriptorParser& parser, DigitiserLayout& layout) {
+    for (size_t i = 0; i < parser.elements.size(); i++) {
+        const HostElement& element = parser.elements[i];
+
+        if (element.usage == 0)
+            continue;
+
+        if (element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_PEN)
+            || element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_TOUCH_SCREEN)
+            || element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_TOUCH_PAD)
+            || element.conformsTo(PAGE_DIGITIZER, USAGE_DIG_DEVICE_CONFIGURATION))
+            classifyDigitiserElement(parser, element, layout);
+    }
+
+    if (!layout.fingers && !layout.styluses)
+        return false;
+
+    layout.contacts_per_report = layout.fingers;
+
+    // A stylus-only digitiser may still declare a maximum contact count
+    if (layout.contact_count_maximum && layout.fingers) {
+        UInt32 maximum = layout.contact_count_maximum_value;
+
+        // Extra finger collections are dropped
+        if (maximum < layout.contacts_per_report) {
+            while (maximum % layout.contacts_per_report != 0)
+                layout.contacts_per_report--;
+        }
+
+        layout.wrappers = maximum / layout.contacts_per_report;
+    }
+
+    if (layout.styluses)
+        layout.wrappers++;
+
+    return true;
+}
+
+/* Reads the report descriptor out of the SYNA3602 override */
+
+static std::vector<UInt8> loadOverrideDescriptor(const char* path) {
+    std::vector<UInt8> descriptor;
+    FILE* file = fopen(path, "r");
+
+    if (!file)
+        return descriptor;
+
+    std::string source;
+    char buffer[4096];
+    size_t length;
+
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        source.append(buffer, length);
+
+    fclose(file);
+
+    size_t start = source.find("report_buffer[] = {");
+    size_t end = start == std::string::npos ? std::string::npos : source.find("};", start);
+
+    if (end == std::string::npos)
+        return descriptor;
+
+    // Only the bytes, not the comments describing them
+    for (size_t i = start; i < end; i++) {
+        if (source.compare(i, 2, "/*") == 0) {
+            size_t close = source.find("*/", i);
+            i = close == std::string::npos ? end : close + 1;
+            continue;
+        }
+
+        if (source.compare(i, 2, "0x") == 0) {
+            descriptor.push_back(static_cast<UInt8>(strtoul(source.c_str() + i, NULL, 16)));
+            i += 3;
+        }
+    }
+
+    return descriptor;
+}
+
+// A touch screen with two fingers per report in inches, and a pen
+static const UInt8 touch_screen_descriptor[] = {
+    0x05, 0x0D, 0x09, 0x04, 0xA1, 0x01, 0x85, 0x01,
+    0x09, 0x22, 0xA1, 0x02, 0x09, 0x42, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x01, 0x81, 0x02,
+    0x09, 0x51, 0x25, 0x0F, 0x75, 0x07, 0x81, 0x02,
+    0x05, 0x01, 0x26, 0xFF, 0x0F, 0x75, 0x10, 0x55, 0x0E, 0x65, 0x13, 0x09, 0x30, 0x46, 0x4A, 0x03, 0x81, 0x02,
+    0x26, 0xFF, 0x09, 0x09, 0x31, 0x46, 0xCE, 0x01, 0x81, 0x02, 0xC0,
+    0x05, 0x0D, 0x09, 0x22, 0xA1, 0x02, 0x09, 0x42, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x01, 0x81, 0x02,
+    0x09, 0x51, 0x25, 0x0F, 0x75, 0x07, 0x81, 0x02,
+    0x05, 0x01, 0x26, 0xFF, 0x0F, 0x75, 0x10, 0x09, 0x30, 0x46, 0x4A, 0x03, 0x81, 0x02,
+    0x26, 0xFF, 0x09, 0x09, 0x31, 0x46, 0xCE, 0x01, 0x81, 0x02, 0xC0,
+    0x05, 0x0D, 0x09, 0x54, 0x25, 0x0A, 0x75, 0x08, 0x81, 0x02,
+    0x85, 0x02, 0x09, 0x55, 0x25, 0x0A, 0xB1, 0x02,
+    0xC0,
+    0x05, 0x0D, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x03,
+    0x09, 0x20, 0xA1, 0x00, 0x09, 0x42, 0x09, 0x44, 0x09, 0x3C, 0x09, 0x45, 0x09, 0x32, 0x25, 0x01, 0x75, 0x01,
+    0x95, 0x05, 0x81, 0x02, 0x95, 0x03, 0x81, 0x03,
+    0x05, 0x01, 0x09, 0x30, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x01, 0x81, 0x02, 0x09, 0x31, 0x81, 0x02,
+    0xC0, 0xC0
+};
+
+// A pen that still declares a Contact Count Maximum
+static const UInt8 stylus_descriptor[] = {
+    0x05, 0x0D, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x07,
+    0x09, 0x20, 0xA1, 0x00, 0x09, 0x42, 0x25, 0x01, 0x75, 0x01, 0x95, 0x01, 0x81, 0x02, 0x95, 0x07, 0x81, 0x03,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x02, 0x81, 0x02, 0xC0,
+    0x05, 0x0D, 0x09, 0x55, 0x25, 0x05, 0x75, 0x08, 0x95, 0x01, 0xB1, 0x02,
+    0xC0
+};
+
+/* Repeats the first finger collection of a descriptor
+ * @descriptor The descriptor
+ * @copies How many more finger collections to add
+ *
+ * @return The inflated descriptor, empty if the descriptor has no finger collection
+ */
+
+static std::vector<UInt8> inflateFingers(const std::vector<UInt8>& descriptor, size_t copies) {
+    // Usage Page (Digitizer), Usage (Finger), Collection (Logical)
+    const UInt8 finger[] = {0x05, 0x0D, 0x09, 0x22, 0xA1, 0x02};
+
+    for (size_t start = 0; start + sizeof(finger) <= descriptor.size(); start++) {
+        if (memcmp(&descriptor[start], finger, sizeof(finger)))
+            continue;
+
+        // Find the matching End Collection
+        size_t end = start + sizeof(finger);
+        int depth = 1;
+
+        while (end < descriptor.size() && depth) {
+            UInt8 prefix = descriptor[end];
+            size_t size = prefix & 0x03;
+
+            if (prefix == 0xC0)
+                depth--;
+            else if ((prefix & 0xFC) == 0xA0)
+                depth++;
+
+            end += 1 + (size == 3 ? 4 : size);
+        }
+
+        std::vector<UInt8> inflated(descriptor.begin(), descriptor.begin() + end);
+
+        for (size_t i = 0; i < copies; i++)
+            inflated.insert(inflated.end(), descriptor.begin() + start, descriptor.begin() + end);
+
+        inflated.insert(inflated.end(), descriptor.begin() + end, descriptor.end());
+
+        return inflated;
+    }
+
+    return std::vector<UInt8>();
+}
+
+static std::vector<UInt8> mutate(HostRandom& random, const std::vector<UInt8>& descriptor) {
+    std::vector<UInt8> mutated = descriptor;
+    UInt32 mutations = 1 + random.below(8);
+
+    for (UInt32 i = 0; i < mutations && !mutated.empty(); i++) {
+        size_t position = random.below(static_cast<UInt32>(mutated.size()));
+
+        switch (random.below(5)) {
+            case 0:
+                mutated[position] ^= static_cast<UInt8>(1 << random.below(8));
+                break;
+            case 1:
+                mutated[position] = static_cast<UInt8>(random.next());
+                break;
+            case 2:
+                mutated.resize(position);
+                break;
+            case 3:
+                mutated.insert(mutated.begin() + position, static_cast<UInt8>(random.next()));
+                break;
+            default:
+                mutated.erase(mutated.begin() + position);
+                break;
+        }
+    }
+
+    return mutated;
+}
+
+static void testSYNA3602(HostTest& test, const std::vector<UInt8>& descriptor) {
+    DescriptorParser parser;
+    DigitiserLayout layout;
+
+    HOST_CHECK(test, descriptor.size() == 0x01DB);
+
+    parser.parse(descriptor);
+
+    HOST_CHECK(test, classifyElements(parser, layout));
+    HOST_CHECK(test, layout.fingers == 4);
+    HOST_CHECK(test, layout.contact_count_maximum_value == 15);
+    HOST_CHECK(test, layout.wrappers == 3);
+    HOST_CHECK(test, layout.styluses == 0);
+    HOST_CHECK(test, layout.contact_count);
+    HOST_CHECK(test, layout.contact_count_maximum);
+    HOST_CHECK(test, layout.scan_time);
+    HOST_CHECK(test, layout.input_mode);
+    HOST_CHECK(test, layout.button);
+    HOST_CHECK(test, layout.logical_max_x == 2628);
+    HOST_CHECK(test, layout.logical_max_y == 1332);
+
+    // 1050 and 700 tenths of a millimetre with an exponent of -2 in centimetres
+    HOST_CHECK(test, layout.physical_max_x == 1050);
+    HOST_CHECK(test, layout.physical_max_y == 700);
+}
+
+static void testHandWritten(HostTest& test) {
+    DescriptorParser parser;
+    DigitiserLayout layout;
+
+    parser.parse(std::vector<UInt8>(touch_screen_descriptor, touch_screen_descriptor + sizeof(touch_screen_descriptor)));
+
+    HOST_CHECK(test, classifyElements(parser, layout));
+    HOST_CHECK(test, layout.fingers == 2);
+    HOST_CHECK(test, layout.styluses == 1);
+    HOST_CHECK(test, layout.wrappers == 6);
+    HOST_CHECK(test, layout.logical_max_x == 4095);
+    HOST_CHECK(test, layout.logical_max_y == 2559);
+
+    // 8.42 by 4.62 inches
+    HOST_CHECK(test, layout.physical_max_x == 2138);
+    HOST_CHECK(test, layout.physical_max_y == 1173);
+
+    // The maximum contact count of a pen says nothing about fingers
+    DigitiserLayout stylus_layout;
+    parser.parse(std::vector<UInt8>(stylus_descriptor, stylus_descriptor + sizeof(stylus_descriptor)));
+
+    HOST_CHECK(test, classifyElements(parser, stylus_layout));
+    HOST_CHECK(test, stylus_layout.fingers == 0);
+    HOST_CHECK(test, stylus_layout.styluses == 1);
+    HOST_CHECK(test, stylus_layout.wrappers == 1);
+}
+
+static void testPhysicalMax(HostTest& test) {
+    HostRandom random(30);
+    int mismatches = 0;
+
+    for (int i = 0; i < 1000000; i++) {
+        UInt32 physical_max = i < 16 * 2 * 64 ? static_cast<UInt32>(0xFFFFFFFFULL >> (i % 64 / 2)) : random.next();
+        UInt32 unit_exponent = i < 16 * 2 * 64 ? static_cast<UInt32>(i / 128) : random.below(256);
+        UInt32 unit = i % 2 ? 0x13 : 0x11;
+
+        UInt32 scaled = VoodooI2CHIDCoordinateTransform::scalePhysicalMax(physical_max, unit_exponent, unit);
+
+        // The exact value in hundredths of a centimetre
+        int exponent = unit_exponent & 0x0F;
+        if (exponent & 0x08)
+            exponent -= 0x10;
+
+        unsigned __int128 numerator = static_cast<unsigned __int128>(physical_max) * (unit == 0x13 ? 254 : 100);
+        unsigned __int128 denominator = 100;
+
+        for (int scale = exponent + 2; scale > 0; scale--)
+            numerator *= 10;
+
+        for (int scale = exponent + 2; scale < 0; scale++)
+            denominator *= 10;
+
+        unsigned __int128 exact = numerator / denominator;
+
+        bool matches;
+
+        if (exact > UINT32_MAX)
+            matches = scaled == UINT32_MAX;
+        else
+            // Dividing before the inch conversion loses less than one hundredth of a centimetre before it is scaled
+            matches = scaled <= exact && exact - scaled <= 3;
+
+        if (!matches)
+            mismatches++;
+    }
+
+    HOST_CHECK(test, mismatches == 0);
+
+    // The largest exponent used to overflow in the inch conversion
+    HOST_CHECK(test, VoodooI2CHIDCoordinateTransform::scalePhysicalMax(0xFFFFFFFF, 7, 0x13) == UINT32_MAX);
+    HOST_CHECK(test, VoodooI2CHIDCoordinateTransform::scalePhysicalMax(0xFFFFFFFF, 0x0E, 0x13) == UINT32_MAX);
+    HOST_CHECK(test, VoodooI2CHIDCoordinateTransform::scalePhysicalMax(1000, 0x0D, 0x11) == 100);
+    HOST_CHECK(test, VoodooI2CHIDCoordinateTransform::scalePhysicalMax(12345, 0x08, 0x11) == 0);
+}
+
+static void testMutations(HostTest& test, const std::vector<std::vector<UInt8>>& corpus) {
+    HostRandom random(3001);
+    DescriptorParser parser;
+    size_t classified = 0;
+
+    for (int i = 0; i < 200000; i++) {
+        const std::vector<UInt8>& original = corpus[random.below(static_cast<UInt32>(corpus.size()))];
+        std::vector<UInt8> mutated = mutate(random, original);
+        DigitiserLayout layout;
+
+        parser.parse(mutated);
+
+        if (classifyElements(parser, layout))
+            classified++;
+
+        // Never more wrappers than the maximum contact count allows
+        if (layout.wrappers > 256) {
+            HOST_CHECK(test, layout.wrappers <= 256);
+            break;
+        }
+    }
+
+    // Most mutations leave a usable digitiser behind
+    HOST_CHECK(test, classified > 100000);
+}
+
+static double parseCost(const std::vector<UInt8>& descriptor, size_t* fingers) {
+    DescriptorParser parser;
+    double best = 0;
+
+    for (int run = 0; run < 5; run++) {
+        DigitiserLayout layout;
+
+        double ns = hostBenchmark(1, [&](int) {
+            parser.parse(descriptor);
+            classifyElements(parser, layout);
+        });
+
+        if (!run || ns < best)
+            best = ns;
+
+        *fingers = layout.fingers;
+    }
+
+    return best;
+}
+
+static void testLargeDescriptors(HostTest& test, const std::vector<UInt8>& syna3602, bool benchmark) {
+    size_t fingers;
+    double small_cost = 0;
+
+    for (size_t copies = 1000; copies <= 16000; copies *= 2) {
+        std::vector<UInt8> inflated = inflateFingers(syna3602, copies);
+        double cost = parseCost(inflated, &fingers);
+
+        HOST_CHECK(test, fingers == copies + 4);
+
+        if (copies == 1000)
+            small_cost = cost;
+
+        if (benchmark)
+            printf("descriptor of %zu bytes: %.1f us, %.2f ns per byte\n", inflated.size(), cost / 1000, cost / inflated.size());
+
+        // Sixteen times the size must not cost anywhere near 256 times as much
+        if (copies == 16000)
+            HOST_CHECK(test, cost < small_cost * 64);
+    }
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    std::vector<UInt8> syna3602 = loadOverrideDescriptor(HOST_SOURCES "/Overrides/VoodooI2CHIDSYNA3602Device.cpp");
+
+    std::vector<std::vector<UInt8>> corpus;
+    corpus.push_back(syna3602);
+    corpus.push_back(std::vector<UInt8>(touch_screen_descriptor, touch_screen_descriptor + sizeof(touch_screen_descriptor)));
+    corpus.push_back(std::vector<UInt8>(stylus_descriptor, stylus_descriptor + sizeof(stylus_descriptor)));
+
+    testSYNA3602(test, syna3602);
+    testHandWritten(test);
+    testPhysicalMax(test);
+    testMutations(test, corpus);
+    testLargeDescriptors(test, syna3602, test.benchmark);
+
+    if (test.benchmark) {
+        for (size_t i = 0; i < corpus.size(); i++) {
+            size_t fingers;
+            printf("corpus descriptor %zu, %zu bytes: %.0f ns\n", i, corpus[i].size(), parseCost(corpus[i], &fingers));
+        }
+    }
+
+    return test.finish("VoodooI2CHIDDescriptorTests");
+}
@@ -0,0 +1,223 @@
+//
+//  VoodooI2CHIDDuplicateFrameFilterTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDDuplicateFrameFilter.hpp"
+
+/* Replays resting finger traces through the duplicate frame filter
+ *
+ * A finger resting on the panel is scanned at 120 Hz for a second with sensor noise that stays within the quantization of
+ * the filter. Every frame after the first repeats it, so the filter only lets the keep-alive frames through. Frames that
+ * move a contact, change a switch or change the contact count are then checked to always pass.
+ */
+
+#define FRAME_INTERVAL_NS 8333333ULL
+#define TRACE_START_NS    1000000000ULL
+#define TRACE_FRAMES      120
+#define REST_X            12000
+#define REST_Y            8000
+
+struct FilterFrame {
+    VoodooI2CDigitiserTransducer fingers[2];
+    VoodooI2CDigitiserStylus stylus;
+    OSArray* transducers;
+    VoodooI2CMultitouchEvent event;
+
+    FilterFrame() {
+        transducers = OSArray::withCapacity(3);
+
+        for (int i = 0; i < 2; i++) {
+            fingers[i].secondary_id = i;
+            transducers->setObject(&fingers[i]);
+        }
+
+        stylus.type = kDigitiserTransducerStylus;
+        transducers->setObject(&stylus);
+
+        event.transducers = transducers;
+        event.contact_count = 0;
+    }
+
+    ~FilterFrame() { delete transducers; }
+
+    void touch(int finger, UInt32 x, UInt32 y, AbsoluteTime timestamp) {
+        VoodooI2CDigitiserTransducer& transducer = fingers[finger];
+
+        transducer.in_range = true;
+        transducer.is_valid = true;
+        transducer.tip_switch.update(1, timestamp);
+        transducer.coordinates.x.update(x, timestamp);
+        transducer.coordinates.y.update(y, timestamp);
+    }
+};
+
+static void testRestingFinger(HostTest& test) {
+    VoodooI2CHIDDuplicateFrameFilter filter;
+    FilterFrame frame;
+    HostRandom random(27);
+    int forwarded = 0;
+    bool keep_alive_in_time = true;
+    AbsoluteTime last_forwarded = 0;
+
+    filter.enabled = true;
+    frame.event.contact_count = 1;
+
+    for (int i = 0; i < TRACE_FRAMES; i++) {
+        AbsoluteTime timestamp = TRACE_START_NS + i * FRAME_INTERVAL_NS;
+
+        // The noise never leaves the quantization step of the rest position
+        frame.touch(0, REST_X + random.below(1 << filter.quantization_shift), REST_Y + random.below(1 << filter.quantization_shift), timestamp);
+
+        if (!filter.shouldForward(frame.event, timestamp))
+            continue;
+
+        // The keep-alive goes out on the first frame that is at least keep_alive_ms past the last one it let through
+        if (forwarded) {
+            uint64_t gap = timestamp - last_forwarded;
+            keep_alive_in_time &= gap >= filter.keep_alive_ms * 1000000ULL && gap < filter.keep_alive_ms * 1000000ULL + FRAME_INTERVAL_NS;
+        }
+
+        forwarded++;
+        last_forwarded = timestamp;
+    }
+
+    int expected = 1 + (TRACE_FRAMES - 1) / ((filter.keep_alive_ms * 1000000ULL + FRAME_INTERVAL_NS - 1) / FRAME_INTERVAL_NS);
+
+    HOST_CHECK(test, forwarded == expected);
+    HOST_CHECK(test, keep_alive_in_time);
+    HOST_CHECK(test, filter.suppressed_frames == TRACE_FRAMES - forwarded);
+}
+
+static void testChangesPass(HostTest& test) {
+    VoodooI2CHIDDuplicateFrameFilter filter;
+    FilterFrame frame;
+    AbsoluteTime timestamp = TRACE_START_NS;
+
+    filter.enabled = true;
+    frame.event.contact_count = 1;
+    frame.touch(0, REST_X, REST_Y, timestamp);
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    // A finger moving by a few quantization steps per frame is never held back
+    int moved = 0;
+
+    for (int i = 1; i <= 30; i++) {
+        timestamp += FRAME_INTERVAL_NS;
+        frame.touch(0, REST_X + i * 40, REST_Y - i * 24, timestamp);
+        moved += filter.shouldForward(frame.event, timestamp);
+    }
+
+    HOST_CHECK(test, moved == 30);
+    HOST_CHECK(test, filter.suppressed_frames == 0);
+
+    timestamp += FRAME_INTERVAL_NS;
+    HOST_CHECK(test, !filter.shouldForward(frame.event, timestamp));
+
+    // A second finger landing
+    timestamp += FRAME_INTERVAL_NS;
+    frame.event.contact_count = 2;
+    frame.touch(1, REST_X + 5000, REST_Y, timestamp);
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    // The first finger lifting in place
+    timestamp += FRAME_INTERVAL_NS;
+    frame.fingers[0].tip_switch.update(0, timestamp);
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    timestamp += FRAME_INTERVAL_NS;
+    frame.fingers[0].is_valid = false;
+    frame.event.contact_count = 1;
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    // A pressure change beyond the quantization
+    timestamp += FRAME_INTERVAL_NS;
+    frame.fingers[1].tip_pressure.update(200, timestamp);
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    // The stylus switches on a pen hovering in place
+    frame.stylus.in_range = true;
+    timestamp += FRAME_INTERVAL_NS;
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    timestamp += FRAME_INTERVAL_NS;
+    frame.stylus.barrel_switch.update(1, timestamp);
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    timestamp += FRAME_INTERVAL_NS;
+    frame.stylus.invert = true;
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    timestamp += FRAME_INTERVAL_NS;
+    frame.stylus.eraser.update(1, timestamp);
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    timestamp += FRAME_INTERVAL_NS;
+    HOST_CHECK(test, !filter.shouldForward(frame.event, timestamp));
+}
+
+static void testDisabledAndReset(HostTest& test) {
+    VoodooI2CHIDDuplicateFrameFilter filter;
+    FilterFrame frame;
+    int forwarded = 0;
+
+    frame.event.contact_count = 1;
+    frame.touch(0, REST_X, REST_Y, TRACE_START_NS);
+
+    // A disabled filter passes everything
+    for (int i = 0; i < 10; i++)
+        forwarded += filter.shouldForward(frame.event, TRACE_START_NS + i * FRAME_INTERVAL_NS);
+
+    HOST_CHECK(test, forwarded == 10);
+    HOST_CHECK(test, filter.suppressed_frames == 0);
+
+    filter.enabled = true;
+    AbsoluteTime timestamp = TRACE_START_NS + 10 * FRAME_INTERVAL_NS;
+
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+    timestamp += FRAME_INTERVAL_NS;
+    HOST_CHECK(test, !filter.shouldForward(frame.event, timestamp));
+
+    // After a reset the same frame goes out again
+    filter.reset();
+    timestamp += FRAME_INTERVAL_NS;
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp));
+
+    // A timestamp going backwards is never taken for a recent frame
+    HOST_CHECK(test, filter.shouldForward(frame.event, timestamp - FRAME_INTERVAL_NS));
+}
+
+static void benchmark() {
+    VoodooI2CHIDDuplicateFrameFilter filter;
+    FilterFrame frame;
+
+    filter.enabled = true;
+    frame.event.contact_count = 2;
+    frame.touch(0, REST_X, REST_Y, TRACE_START_NS);
+    frame.touch(1, REST_X + 5000, REST_Y, TRACE_START_NS);
+
+    volatile UInt32 sink = 0;
+
+    double ns = hostBenchmark(10000000, [&](int i) {
+        sink = sink + filter.shouldForward(frame.event, TRACE_START_NS + i * FRAME_INTERVAL_NS);
+    });
+
+    printf("duplicate frame filter: %.1f ns per frame of 2 fingers and a stylus\n", ns);
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testRestingFinger(test);
+    testChangesPass(test);
+    testDisabledAndReset(test);
+
+    if (test.benchmark)
+        benchmark();
+
+    return test.finish("VoodooI2CHIDDuplicateFrameFilterTests");
+}
@@ -0,0 +1,403 @@
+//
+//  VoodooI2CHIDFrameAssemblerTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include <vector>
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDFrameAssembler.hpp"
+
+/* Replays hybrid mode traces through the frame assembler
+ *
+ * <FrameReplay> drives the assembler the way <VoodooI2CMultitouchHIDEventDriver::decodeFrame> and
+ * <VoodooI2CMultitouchHIDEventDriver::frameAssemblyTimeout> do, with the frame timer firing once a report arrives past
+ * its deadline. Reports are then dropped from the traces to check that every frame is still delivered exactly once.
+ */
+
+#define CONTACTS_PER_REPORT 2
+#define MAXIMUM_CONTACTS    10
+#define REPORT_INTERVAL_NS  1000000ULL
+
+struct TraceReport {
+    uint64_t timestamp;
+    UInt8 contact_count;
+    UInt16 frame;
+    std::vector<UInt8> contacts;
+};
+
+struct DeliveredFrame {
+    uint64_t timestamp;
+    std::vector<UInt16> frames;
+    std::vector<UInt8> contacts;
+};
+
+struct FrameReplay {
+    VoodooI2CHIDFrameAssembler assembler;
+    std::vector<DeliveredFrame> delivered;
+
+    uint64_t timer_deadline = 0;
+    DeliveredFrame current;
+
+    FrameReplay() {
+        assembler.configure(CONTACTS_PER_REPORT, MAXIMUM_CONTACTS, true);
+    }
+
+    void flush(uint64_t timestamp) {
+        timer_deadline = 0;
+
+        if (assembler.getReceivedContactCount())
+            deliver(timestamp);
+
+        current = DeliveredFrame();
+        assembler.finishFrame();
+    }
+
+    void deliver(uint64_t timestamp) {
+        current.timestamp = timestamp;
+        delivered.push_back(current);
+        current = DeliveredFrame();
+    }
+
+    void fireTimer(uint64_t now) {
+        if (!timer_deadline || now < timer_deadline)
+            return;
+
+        timer_deadline = 0;
+
+        if (!assembler.isPending())
+            return;
+
+        assembler.incomplete_frames++;
+        flush(now);
+    }
+
+    void report(const TraceReport& report) {
+        fireTimer(report.timestamp);
+
+        if (report.contact_count) {
+            if (assembler.isPending()) {
+                assembler.recovered_frames++;
+                flush(report.timestamp);
+            }
+
+            assembler.beginFrame(report.timestamp, report.contact_count);
+        } else if (!assembler.isPending()) {
+            assembler.orphaned_reports++;
+            assembler.beginFrame(report.timestamp, 0);
+        }
+
+        current.frames.push_back(report.frame);
+
+        for (size_t i = 0; i < report.contacts.size(); i++) {
+            assembler.addContact(report.contacts[i]);
+            current.contacts.push_back(report.contacts[i]);
+        }
+
+        assembler.endReport();
+
+        if (!assembler.isComplete()) {
+            if (assembler.getCurrentReport() == 1)
+                timer_deadline = report.timestamp + assembler.getTimeoutUS() * 1000ULL;
+
+            return;
+        }
+
+        timer_deadline = 0;
+        deliver(report.timestamp);
+        assembler.finishFrame();
+    }
+
+    void finish(uint64_t now) {
+        fireTimer(now);
+    }
+};
+
+/* Builds a trace of frames scanned at a fixed rate
+ * @random Picks the number of contacts in each frame
+ * @frames The number of frames
+ * @period_ns The time between the first reports of two frames
+ * @touch_gap_every Insert an idle gap after every this many frames, 0 for none
+ */
+
+static std::vector<TraceReport> buildTrace(HostRandom& random, int frames, uint64_t period_ns, int touch_gap_every) {
+    std::vector<TraceReport> trace;
+    uint64_t frame_start = 1000000000ULL;
+
+    for (int frame = 0; frame < frames; frame++) {
+        UInt8 contacts = static_cast<UInt8>(1 + random.below(MAXIMUM_CONTACTS));
+        UInt8 reports = static_cast<UInt8>((contacts + CONTACTS_PER_REPORT - 1) / CONTACTS_PER_REPORT);
+
+        for (UInt8 i = 0; i < reports; i++) {
+            TraceReport report;
+            report.timestamp = frame_start + i * REPORT_INTERVAL_NS;
+            report.contact_count = i ? 0 : contacts;
+            report.frame = static_cast<UInt16>(frame);
+
+            for (UInt8 contact = i * CONTACTS_PER_REPORT; contact < contacts && contact < (i + 1) * CONTACTS_PER_REPORT; contact++)
+                report.contacts.push_back(contact);
+
+            trace.push_back(report);
+        }
+
+        frame_start += period_ns;
+
+        if (touch_gap_every && (frame + 1) % touch_gap_every == 0)
+            frame_start += 200000000ULL;
+    }
+
+    return trace;
+}
+
+/* Every delivered frame holds the contacts of a single scanned frame */
+
+static bool framesAreSeparate(const FrameReplay& replay) {
+    for (size_t i = 0; i < replay.delivered.size(); i++) {
+        const std::vector<UInt16>& frames = replay.delivered[i].frames;
+
+        for (size_t j = 1; j < frames.size(); j++) {
+            if (frames[j] != frames[0])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static size_t deliveredContacts(const FrameReplay& replay) {
+    size_t contacts = 0;
+
+    for (size_t i = 0; i < replay.delivered.size(); i++)
+        contacts += replay.delivered[i].contacts.size();
+
+    return contacts;
+}
+
+static void testCleanTrace(HostTest& test) {
+    HostRandom random(26);
+    std::vector<TraceReport> trace = buildTrace(random, 2000, 8333333ULL, 0);
+    FrameReplay replay;
+
+    size_t contacts = 0;
+
+    for (size_t i = 0; i < trace.size(); i++) {
+        replay.report(trace[i]);
+        contacts += trace[i].contacts.size();
+    }
+
+    replay.finish(trace.back().timestamp + 1000000000ULL);
+
+    HOST_CHECK(test, replay.delivered.size() == 2000);
+    HOST_CHECK(test, deliveredContacts(replay) == contacts);
+    HOST_CHECK(test, framesAreSeparate(replay));
+    HOST_CHECK(test, replay.assembler.incomplete_frames == 0);
+    HOST_CHECK(test, replay.assembler.recovered_frames == 0);
+    HOST_CHECK(test, replay.assembler.orphaned_reports == 0);
+
+    // The timeout follows the 120 Hz scan rate
+    HOST_CHECK(test, replay.assembler.getTimeoutUS() >= 12000 && replay.assembler.getTimeoutUS() <= 13000);
+}
+
+static void testDroppedContinuations(HostTest& test) {
+    HostRandom random(2601);
+    std::vector<TraceReport> trace = buildTrace(random, 4000, 8333333ULL, 50);
+    FrameReplay replay;
+
+    std::vector<bool> truncated(4000, false);
+    size_t contacts = 0;
+    UInt32 truncated_frames = 0;
+
+    for (size_t i = 0; i < trace.size(); i++) {
+        if (!trace[i].contact_count && random.below(10) == 0) {
+            if (!truncated[trace[i].frame])
+                truncated_frames++;
+
+            truncated[trace[i].frame] = true;
+            continue;
+        }
+
+        replay.report(trace[i]);
+        contacts += trace[i].contacts.size();
+    }
+
+    replay.finish(trace.back().timestamp + 1000000000ULL);
+
+    // Each truncated frame is delivered by the next frame or by the timer, never held back or merged
+    HOST_CHECK(test, replay.delivered.size() == 4000);
+    HOST_CHECK(test, deliveredContacts(replay) == contacts);
+    HOST_CHECK(test, framesAreSeparate(replay));
+    HOST_CHECK(test, truncated_frames > 0);
+    HOST_CHECK(test, replay.assembler.incomplete_frames + replay.assembler.recovered_frames == truncated_frames);
+    HOST_CHECK(test, replay.assembler.incomplete_frames > 0);
+    HOST_CHECK(test, replay.assembler.recovered_frames > 0);
+    HOST_CHECK(test, replay.assembler.orphaned_reports == 0);
+
+    for (size_t i = 0; i < replay.delivered.size(); i++) {
+        UInt16 frame = replay.delivered[i].frames[0];
+
+        if (truncated[frame])
+            continue;
+
+        // Frames that were not truncated are delivered as soon as their last report arrives
+        bool delivered_on_time = true;
+
+        for (size_t j = 0; j < trace.size(); j++) {
+            if (trace[j].frame == frame && trace[j].timestamp > replay.delivered[i].timestamp)
+                delivered_on_time = false;
+        }
+
+        if (!delivered_on_time) {
+            HOST_CHECK(test, delivered_on_time);
+            break;
+        }
+    }
+}
+
+static void testDroppedFirstReports(HostTest& test) {
+    HostRandom random(2602);
+    std::vector<TraceReport> trace = buildTrace(random, 4000, 8333333ULL, 0);
+    FrameReplay replay;
+
+    size_t contacts = 0;
+    UInt32 headless_frames = 0;
+    UInt32 orphans = 0;
+    bool dropping = false;
+
+    for (size_t i = 0; i < trace.size(); i++) {
+        if (trace[i].contact_count) {
+            dropping = random.below(10) == 0;
+
+            if (dropping && i + 1 < trace.size() && !trace[i + 1].contact_count)
+                headless_frames++;
+        }
+
+        if (dropping) {
+            if (trace[i].contact_count)
+                continue;
+
+            orphans++;
+        }
+
+        replay.report(trace[i]);
+        contacts += trace[i].contacts.size();
+    }
+
+    replay.finish(trace.back().timestamp + 1000000000ULL);
+
+    // The remaining reports of a frame that lost its first report are each delivered on their own
+    HOST_CHECK(test, headless_frames > 0);
+    HOST_CHECK(test, replay.assembler.orphaned_reports == orphans);
+    HOST_CHECK(test, replay.assembler.incomplete_frames == 0);
+    HOST_CHECK(test, replay.assembler.recovered_frames == 0);
+    HOST_CHECK(test, deliveredContacts(replay) == contacts);
+    HOST_CHECK(test, framesAreSeparate(replay));
+}
+
+static void testTimeoutBeforeIdle(HostTest& test) {
+    FrameReplay replay;
+
+    TraceReport first;
+    first.timestamp = 1000000000ULL;
+    first.contact_count = 4;
+    first.frame = 0;
+    first.contacts.push_back(0);
+    first.contacts.push_back(1);
+
+    replay.report(first);
+
+    HOST_CHECK(test, replay.delivered.empty());
+    HOST_CHECK(test, replay.assembler.isPending());
+
+    uint64_t deadline = replay.timer_deadline;
+
+    // Nothing is delivered until the deadline, then the half frame is
+    replay.finish(deadline - 1);
+    HOST_CHECK(test, replay.delivered.empty());
+
+    replay.finish(deadline);
+    HOST_CHECK(test, replay.delivered.size() == 1);
+    HOST_CHECK(test, replay.delivered.size() == 1 && replay.delivered[0].contacts.size() == 2);
+    HOST_CHECK(test, replay.assembler.incomplete_frames == 1);
+    HOST_CHECK(test, !replay.assembler.isPending());
+
+    // A lone lift report after the touch has ended
+    TraceReport lift;
+    lift.timestamp = deadline + 50000000ULL;
+    lift.contact_count = 0;
+    lift.frame = 1;
+    lift.contacts.push_back(0);
+
+    replay.report(lift);
+
+    HOST_CHECK(test, replay.assembler.orphaned_reports == 1);
+    HOST_CHECK(test, replay.delivered.size() == 2);
+    HOST_CHECK(test, !replay.assembler.isPending());
+}
+
+static void testCadence(HostTest& test) {
+    const uint64_t periods_ns[] = {16666667ULL, 8333333ULL, 4166667ULL, 2000000ULL, 50000000ULL};
+    const UInt32 expected_us[] = {25000, 12500, 6250, FRAME_ASSEMBLER_MIN_TIMEOUT_US, FRAME_ASSEMBLER_MAX_TIMEOUT_US};
+
+    for (int i = 0; i < 5; i++) {
+        VoodooI2CHIDFrameAssembler assembler;
+        assembler.configure(CONTACTS_PER_REPORT, MAXIMUM_CONTACTS, true);
+
+        for (int frame = 0; frame < 200; frame++) {
+            assembler.beginFrame(1000000000ULL + frame * periods_ns[i], 1);
+            assembler.finishFrame();
+        }
+
+        UInt32 timeout = assembler.getTimeoutUS();
+        HOST_CHECK(test, timeout + 100 >= expected_us[i] && timeout <= expected_us[i] + 100);
+    }
+
+    // Gaps between touches leave the cadence alone
+    VoodooI2CHIDFrameAssembler assembler;
+    assembler.configure(CONTACTS_PER_REPORT, MAXIMUM_CONTACTS, true);
+
+    uint64_t timestamp = 1000000000ULL;
+
+    for (int frame = 0; frame < 200; frame++) {
+        timestamp += frame % 20 ? 8333333ULL : 500000000ULL;
+        assembler.beginFrame(timestamp, 1);
+        assembler.finishFrame();
+    }
+
+    HOST_CHECK(test, assembler.getTimeoutUS() >= 12000 && assembler.getTimeoutUS() <= 13000);
+}
+
+static void benchmark() {
+    HostRandom random(26);
+    std::vector<TraceReport> trace = buildTrace(random, 2000, 8333333ULL, 0);
+    FrameReplay replay;
+
+    double ns = hostBenchmark(static_cast<int>(trace.size()) * 50, [&](int i) {
+        replay.assembler.beginFrame(trace[i % trace.size()].timestamp, trace[i % trace.size()].contact_count);
+
+        for (size_t j = 0; j < trace[i % trace.size()].contacts.size(); j++)
+            replay.assembler.addContact(trace[i % trace.size()].contacts[j]);
+
+        replay.assembler.endReport();
+        replay.assembler.finishFrame();
+    });
+
+    printf("frame assembler: %.1f ns per report\n", ns);
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testCleanTrace(test);
+    testDroppedContinuations(test);
+    testDroppedFirstReports(test);
+    testTimeoutBeforeIdle(test);
+    testCadence(test);
+
+    if (test.benchmark)
+        benchmark();
+
+    return test.finish("VoodooI2CHIDFrameAssemblerTests");
+}
@@ -0,0 +1,266 @@
+//
+//  VoodooI2CHIDGestureRecognizerTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include <math.h>
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDGestureRecognizer.hpp"
+
+/* Replays two finger touch screen traces through the gesture recogniser
+ *
+ * Every trace moves the centroid of the fingers, scales the distance between them and turns the line through them by a
+ * known amount over half a second at 120 Hz, with sensor noise on top. The events that come out are checked against
+ * what the trace did.
+ */
+
+#define FRAME_INTERVAL_NS 8333333ULL
+#define TRACE_START_NS    1000000000ULL
+#define TRACE_FRAMES      60
+#define FINGER_JITTER     16
+
+struct GestureTrace {
+    double pan_x;
+    double pan_y;
+    double scale;
+    double rotation;
+};
+
+struct GestureOutcome {
+    UInt32 began[3];
+    UInt32 ended[3];
+    SInt64 pan_x;
+    SInt64 pan_y;
+    double scale;
+    double rotation;
+    bool ordered;
+};
+
+/* Replays a trace
+ * @trace What the fingers do
+ * @swap_order *true* to have the panel report the fingers in a different order every other frame
+ * @seed Seeds the sensor noise
+ */
+
+static GestureOutcome replayTrace(const GestureTrace& trace, bool swap_order, UInt32 seed) {
+    HostRandom random(seed);
+    VoodooI2CHIDGestureRecognizer recognizer;
+    VoodooI2CHIDGestureEvent events[GESTURE_MAX_EVENTS];
+    GestureOutcome outcome = {};
+
+    outcome.scale = 1;
+    outcome.ordered = true;
+
+    bool running[3] = {};
+
+    for (int frame = 0; frame <= TRACE_FRAMES + 1; frame++) {
+        AbsoluteTime timestamp = TRACE_START_NS + frame * FRAME_INTERVAL_NS;
+        UInt8 count;
+
+        if (frame <= TRACE_FRAMES) {
+            double progress = static_cast<double>(frame) / TRACE_FRAMES;
+            double centre_x = 30000 + trace.pan_x * progress;
+            double centre_y = 30000 + trace.pan_y * progress;
+            double distance = 8000 * (1 + (trace.scale - 1) * progress);
+            double angle = 0.3 + trace.rotation * progress;
+
+            IOFixed x[2], y[2];
+
+            for (int finger = 0; finger < 2; finger++) {
+                double side = finger ? 0.5 : -0.5;
+                x[finger] = static_cast<IOFixed>(centre_x + side * distance * cos(angle)) + random.below(2 * FINGER_JITTER + 1) - FINGER_JITTER;
+                y[finger] = static_cast<IOFixed>(centre_y + side * distance * sin(angle)) + random.below(2 * FINGER_JITTER + 1) - FINGER_JITTER;
+            }
+
+            if (swap_order && frame % 2)
+                count = recognizer.update(7, x[1], y[1], 3, x[0], y[0], timestamp, events);
+            else
+                count = recognizer.update(3, x[0], y[0], 7, x[1], y[1], timestamp, events);
+        } else {
+            // The fingers lift
+            count = recognizer.end(timestamp, events);
+        }
+
+        for (int i = 0; i < count; i++) {
+            const VoodooI2CHIDGestureEvent& event = events[i];
+
+            // Began, changed for as long as it runs, then ended
+            if (event.phase == kVoodooI2CHIDGestureBegan) {
+                outcome.ordered &= !running[event.type];
+                running[event.type] = true;
+                outcome.began[event.type]++;
+            } else {
+                outcome.ordered &= running[event.type];
+
+                if (event.phase == kVoodooI2CHIDGestureEnded) {
+                    running[event.type] = false;
+                    outcome.ended[event.type]++;
+                }
+            }
+
+            outcome.ordered &= event.timestamp == timestamp;
+
+            if (event.type == kVoodooI2CHIDGesturePan) {
+                outcome.pan_x += event.delta_x;
+                outcome.pan_y += event.delta_y;
+            } else if (event.type == kVoodooI2CHIDGesturePinch) {
+                outcome.scale = event.scale / 65536.0;
+            } else {
+                outcome.rotation = event.rotation / 65536.0;
+            }
+        }
+    }
+
+    for (int type = kVoodooI2CHIDGesturePan; type <= kVoodooI2CHIDGestureRotate; type++)
+        outcome.ordered &= !recognizer.isActive(static_cast<VoodooI2CHIDGestureType>(type));
+
+    return outcome;
+}
+
+/* Checks that a trace produced exactly the gestures it performed, each with the right amount
+ * @test The test to record the checks in
+ * @trace What the fingers did
+ * @outcome What the recogniser made of it
+ */
+
+static void checkOutcome(HostTest& test, const GestureTrace& trace, const GestureOutcome& outcome) {
+    bool panned = hypot(trace.pan_x, trace.pan_y) > GESTURE_PAN_THRESHOLD;
+    bool pinched = fabs(8000 * (trace.scale - 1)) > GESTURE_PINCH_THRESHOLD;
+    bool rotated = fabs(trace.rotation) > GESTURE_ROTATE_THRESHOLD / 65536.0;
+
+    HOST_CHECK(test, outcome.ordered);
+    HOST_CHECK(test, outcome.began[kVoodooI2CHIDGesturePan] == panned && outcome.ended[kVoodooI2CHIDGesturePan] == panned);
+    HOST_CHECK(test, outcome.began[kVoodooI2CHIDGesturePinch] == pinched && outcome.ended[kVoodooI2CHIDGesturePinch] == pinched);
+    HOST_CHECK(test, outcome.began[kVoodooI2CHIDGestureRotate] == rotated && outcome.ended[kVoodooI2CHIDGestureRotate] == rotated);
+
+    // The pan deltas add up to where the centroid went, give or take the noise of one frame
+    if (panned) {
+        HOST_CHECK(test, fabs(outcome.pan_x - trace.pan_x) <= FINGER_JITTER + 1);
+        HOST_CHECK(test, fabs(outcome.pan_y - trace.pan_y) <= FINGER_JITTER + 1);
+    }
+
+    if (pinched)
+        HOST_CHECK(test, fabs(outcome.scale - trace.scale) < trace.scale * 0.01);
+
+    // Noise on two fingers 8000 units apart turns the line between them by up to 0.004 radians
+    if (rotated)
+        HOST_CHECK(test, fabs(outcome.rotation - trace.rotation) < fabs(trace.rotation) * 0.01 + 0.005);
+}
+
+static void testTraces(HostTest& test) {
+    const GestureTrace traces[] = {
+        {20000, 0, 1, 0},           // Pan along X
+        {-6000, 12000, 1, 0},       // Pan across
+        {0, 0, 2, 0},               // Pinch out
+        {0, 0, 0.5, 0},             // Pinch in
+        {0, 0, 1, 1.2},             // Rotate anticlockwise
+        {0, 0, 1, -0.8},            // Rotate clockwise
+        {10000, -4000, 1.5, 0.8}    // All at once
+    };
+
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        checkOutcome(test, traces[i], replayTrace(traces[i], false, 47 + i));
+
+        // The panel reporting the fingers in either order makes no difference
+        checkOutcome(test, traces[i], replayTrace(traces[i], true, 470 + i));
+    }
+}
+
+static void testStillFingers(HostTest& test) {
+    // Fingers resting on the glass or drifting a little never make a gesture
+    const GestureTrace traces[] = {
+        {0, 0, 1, 0},
+        {200, -300, 1.05, 0.05}
+    };
+
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        GestureOutcome outcome = replayTrace(traces[i], true, 4700 + i);
+
+        HOST_CHECK(test, outcome.began[kVoodooI2CHIDGesturePan] == 0);
+        HOST_CHECK(test, outcome.began[kVoodooI2CHIDGesturePinch] == 0);
+        HOST_CHECK(test, outcome.began[kVoodooI2CHIDGestureRotate] == 0);
+    }
+}
+
+static void testNewFingers(HostTest& test) {
+    VoodooI2CHIDGestureRecognizer recognizer;
+    VoodooI2CHIDGestureEvent events[GESTURE_MAX_EVENTS];
+    AbsoluteTime timestamp = TRACE_START_NS;
+
+    HOST_CHECK(test, recognizer.update(1, 10000, 10000, 2, 20000, 10000, timestamp, events) == 0);
+
+    timestamp += FRAME_INTERVAL_NS;
+    UInt8 count = recognizer.update(1, 12000, 10000, 2, 22000, 10000, timestamp, events);
+
+    HOST_CHECK(test, count == 1 && events[0].type == kVoodooI2CHIDGesturePan && events[0].phase == kVoodooI2CHIDGestureBegan);
+    HOST_CHECK(test, events[0].delta_x == 2000 && events[0].delta_y == 0);
+    HOST_CHECK(test, events[0].x == 17000 && events[0].y == 10000);
+
+    // A different finger ends the pan and starts over from where the new pair is, without a jump
+    timestamp += FRAME_INTERVAL_NS;
+    count = recognizer.update(1, 12000, 10000, 5, 40000, 40000, timestamp, events);
+
+    HOST_CHECK(test, count == 1 && events[0].phase == kVoodooI2CHIDGestureEnded);
+    HOST_CHECK(test, !recognizer.isActive(kVoodooI2CHIDGesturePan));
+    HOST_CHECK(test, recognizer.recognised[kVoodooI2CHIDGesturePan] == 1);
+
+    timestamp += FRAME_INTERVAL_NS;
+    HOST_CHECK(test, recognizer.update(1, 12000, 10000, 5, 40000, 40000, timestamp, events) == 0);
+
+    // Ending with nothing running says nothing
+    HOST_CHECK(test, recognizer.end(timestamp, events) == 0);
+
+    // Fingers on top of each other have no direction and no length, and neither divides by zero
+    HOST_CHECK(test, recognizer.update(1, 30000, 30000, 2, 30000, 30000, timestamp, events) == 0);
+    timestamp += FRAME_INTERVAL_NS;
+    count = recognizer.update(1, 30000, 30000, 2, 34000, 30000, timestamp, events);
+
+    bool pinched = false;
+
+    for (int i = 0; i < count; i++)
+        pinched |= events[i].type == kVoodooI2CHIDGesturePinch && events[i].scale == 0x10000;
+
+    HOST_CHECK(test, pinched);
+}
+
+static void benchmark() {
+    VoodooI2CHIDGestureRecognizer recognizer;
+    VoodooI2CHIDGestureEvent events[GESTURE_MAX_EVENTS];
+    HostRandom random(47);
+    IOFixed coordinates[4096][4];
+
+    for (int i = 0; i < 4096; i++) {
+        double angle = i * 0.01;
+
+        coordinates[i][0] = 30000 - static_cast<IOFixed>(4000 * cos(angle)) + random.below(33);
+        coordinates[i][1] = 30000 - static_cast<IOFixed>(4000 * sin(angle)) + random.below(33);
+        coordinates[i][2] = 30000 + static_cast<IOFixed>(4000 * cos(angle)) + random.below(33);
+        coordinates[i][3] = 30000 + static_cast<IOFixed>(4000 * sin(angle)) + random.below(33);
+    }
+
+    volatile UInt32 sink = 0;
+
+    double ns = hostBenchmark(10000000, [&](int i) {
+        const IOFixed* frame = coordinates[i & 4095];
+        sink = sink + recognizer.update(1, frame[0], frame[1], 2, frame[2], frame[3], TRACE_START_NS + i * FRAME_INTERVAL_NS, events);
+    });
+
+    printf("gesture recogniser: %.1f ns per frame of 2 contacts\n", ns);
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testTraces(test);
+    testStillFingers(test);
+    testNewFingers(test);
+
+    if (test.benchmark)
+        benchmark();
+
+    return test.finish("VoodooI2CHIDGestureRecognizerTests");
+}
@@ -0,0 +1,181 @@
+//
+//  VoodooI2CHIDLongPressRecognizerTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDLongPressRecognizer.hpp"
+
+/* Replays touch screen traces scanned at 60, 120 and 240 Hz through the long press recogniser
+ *
+ * A press has to fire once and at the same time whatever the scan rate of the panel, in spite of sensor noise, and
+ * anything that moves on has to start over.
+ */
+
+#define TRACE_START_NS 1000000000ULL
+
+static const UInt32 scan_rates[] = {60, 120, 240};
+
+struct PressReplay {
+    VoodooI2CHIDLongPressRecognizer recognizer;
+    HostRandom random;
+    UInt32 rate;
+    UInt32 frame = 0;
+
+    PressReplay(UInt32 rate, UInt32 seed) : random(seed), rate(rate) {
+        recognizer.configure(LONG_PRESS_DEFAULT_DURATION, LONG_PRESS_DEFAULT_RADIUS);
+    }
+
+    AbsoluteTime timestamp() const {
+        return TRACE_START_NS + (frame * 1000000000ULL) / rate;
+    }
+
+    /* Feeds the next frame
+     * @x The X coordinate of the finger
+     * @y The Y coordinate of the finger
+     * @jitter How far the panel may misreport the finger on either axis
+     *
+     * @return *true* if the long press fired on this frame
+     */
+
+    bool next(IOFixed x, IOFixed y, UInt32 jitter) {
+        IOFixed noisy_x = x + static_cast<IOFixed>(random.below(2 * jitter + 1)) - static_cast<IOFixed>(jitter);
+        IOFixed noisy_y = y + static_cast<IOFixed>(random.below(2 * jitter + 1)) - static_cast<IOFixed>(jitter);
+
+        bool fired = recognizer.update(noisy_x, noisy_y, timestamp());
+        frame++;
+
+        return fired;
+    }
+};
+
+// A 4096 wide panel reporting a resting finger a couple of logical units off either way
+#define RESTING_JITTER (2 * 16)
+
+// How far a press may drift from where it settled, in the 0 - 65535 range
+#define RADIUS ((LONG_PRESS_DEFAULT_RADIUS * 65535) / 1000)
+
+static void testRestingFinger(HostTest& test, UInt32 rate) {
+    PressReplay replay(rate, rate);
+    int fired = 0;
+    AbsoluteTime fired_at = 0;
+
+    for (UInt32 i = 0; i < rate * 3; i++) {
+        AbsoluteTime timestamp = replay.timestamp();
+
+        if (replay.next(30000, 20000, RESTING_JITTER)) {
+            fired++;
+            fired_at = timestamp;
+        }
+    }
+
+    HOST_CHECK(test, fired == 1);
+
+    // On the first frame at least the duration after touch down, whatever the rate
+    uint64_t duration_ns = LONG_PRESS_DEFAULT_DURATION * 1000000ULL;
+    HOST_CHECK(test, fired_at >= TRACE_START_NS + duration_ns);
+    HOST_CHECK(test, fired_at < TRACE_START_NS + duration_ns + 1000000000ULL / rate);
+}
+
+static void testNoiseWithinRadius(HostTest& test, UInt32 rate) {
+    // A finger rolling on the glass, the radius is measured from a sample that is just as noisy as the others so any
+    // two samples may be almost the whole radius apart
+    PressReplay replay(rate, rate + 1);
+    int fired = 0;
+
+    for (UInt32 i = 0; i < rate * 2; i++)
+        fired += replay.next(30000, 20000, RADIUS * 35 / 100);
+
+    HOST_CHECK(test, fired == 1);
+}
+
+static void testMovingFinger(HostTest& test, UInt32 rate) {
+    PressReplay replay(rate, rate + 2);
+    int fired = 0;
+
+    // A slow drag covers the radius in under the duration and never fires
+    for (UInt32 i = 0; i < rate * 3; i++)
+        fired += replay.next(10000 + (i * RADIUS * 4) / rate, 20000, RESTING_JITTER);
+
+    HOST_CHECK(test, fired == 0);
+
+    // It fires once the drag comes to rest, a duration after it last settled, which is at most the quarter of a second
+    // the drag takes to cover the radius before it stopped
+    UInt32 stopped = replay.frame;
+    UInt32 fired_frame = 0;
+
+    for (UInt32 i = 0; i < rate * 2; i++) {
+        if (replay.next(10000 + 3 * RADIUS * 4, 20000, RESTING_JITTER))
+            fired_frame = replay.frame - 1;
+    }
+
+    HOST_CHECK(test, fired_frame > stopped);
+    HOST_CHECK(test, fired_frame - stopped + rate / 4 + 1 >= rate * LONG_PRESS_DEFAULT_DURATION / 1000);
+    HOST_CHECK(test, fired_frame - stopped <= rate * LONG_PRESS_DEFAULT_DURATION / 1000 + 1);
+}
+
+static void testLift(HostTest& test, UInt32 rate) {
+    PressReplay replay(rate, rate + 3);
+    int fired = 0;
+
+    // Lifting just before the duration and touching down again at the same spot starts over
+    for (UInt32 i = 0; i < rate * 9 / 10; i++)
+        fired += replay.next(30000, 20000, RESTING_JITTER);
+
+    replay.recognizer.reset();
+
+    UInt32 touch_down = replay.frame;
+    UInt32 fired_frame = 0;
+
+    for (UInt32 i = 0; i < rate * 2; i++) {
+        if (replay.next(30000, 20000, RESTING_JITTER)) {
+            fired++;
+            fired_frame = replay.frame - 1;
+        }
+    }
+
+    HOST_CHECK(test, fired == 1);
+    HOST_CHECK(test, fired_frame - touch_down >= rate * LONG_PRESS_DEFAULT_DURATION / 1000);
+}
+
+static void testConfiguration(HostTest& test) {
+    VoodooI2CHIDLongPressRecognizer recognizer;
+
+    // Half a second and a radius of 5 per mille
+    recognizer.configure(500, 5);
+
+    HOST_CHECK(test, !recognizer.update(1000, 1000, TRACE_START_NS));
+    HOST_CHECK(test, !recognizer.update(1000 + 327, 1000, TRACE_START_NS + 499999999ULL));
+    HOST_CHECK(test, recognizer.update(1000, 1000 + 327, TRACE_START_NS + 500000000ULL));
+
+    // Once per press
+    HOST_CHECK(test, !recognizer.update(1000, 1000, TRACE_START_NS + 900000000ULL));
+
+    // Just past the radius settles the press again
+    HOST_CHECK(test, !recognizer.update(1000 + 328, 1000, TRACE_START_NS + 1000000000ULL));
+    HOST_CHECK(test, !recognizer.update(1000 + 328, 1000, TRACE_START_NS + 1499999999ULL));
+    HOST_CHECK(test, recognizer.update(1000 + 328, 1000, TRACE_START_NS + 1500000000ULL));
+
+    // A timestamp going backwards never fires
+    recognizer.reset();
+    HOST_CHECK(test, !recognizer.update(1000, 1000, TRACE_START_NS + 2000000000ULL));
+    HOST_CHECK(test, !recognizer.update(1000, 1000, TRACE_START_NS));
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    for (size_t i = 0; i < sizeof(scan_rates) / sizeof(scan_rates[0]); i++) {
+        testRestingFinger(test, scan_rates[i]);
+        testNoiseWithinRadius(test, scan_rates[i]);
+        testMovingFinger(test, scan_rates[i]);
+        testLift(test, scan_rates[i]);
+    }
+
+    testConfiguration(test);
+
+    return test.finish("VoodooI2CHIDLongPressRecognizerTests");
+}
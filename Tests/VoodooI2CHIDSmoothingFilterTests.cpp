@@ -0,0 +1,267 @@
+//
+//  VoodooI2CHIDSmoothingFilterTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include <math.h>
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDSmoothingFilter.hpp"
+
+/* Replays noisy finger traces through the smoothing filter
+ *
+ * Every trace is a known path with sensor noise added on top. The filter output is compared against the path itself:
+ * a resting finger measures how much jitter is removed and a finger moving at constant speed measures how far the
+ * output lags behind it.
+ */
+
+#define FRAME_INTERVAL_NS 8333333ULL
+#define TRACE_START_NS    1000000000ULL
+
+struct TracePoint {
+    double x;
+    double y;
+};
+
+struct FilterReplay {
+    VoodooI2CHIDSmoothingFilter filter;
+    VoodooI2CDigitiserTransducer transducer;
+    OSArray* transducers;
+
+    FilterReplay() {
+        transducers = OSArray::withCapacity(1);
+        transducers->setObject(&transducer);
+        filter.enabled = true;
+    }
+
+    ~FilterReplay() {
+        delete transducers;
+    }
+
+    /* Runs a single sample through the filter
+     * @timestamp The time of the sample
+     * @x The raw X coordinate
+     * @y The raw Y coordinate
+     * @touching *false* to lift the finger
+     *
+     * @return The filtered position
+     */
+
+    TracePoint sample(uint64_t timestamp, UInt32 x, UInt32 y, bool touching = true) {
+        transducer.tip_switch.update(touching, timestamp);
+        transducer.coordinates.x.update(x, timestamp);
+        transducer.coordinates.y.update(y, timestamp);
+
+        VoodooI2CHIDInputFrame frame;
+        frame.timestamp = timestamp;
+        frame.report = NULL;
+        frame.report_type = kIOHIDReportTypeInput;
+        frame.report_id = 0;
+        frame.event.transducers = transducers;
+        frame.event.contact_count = 1;
+
+        filter.processFrame(frame);
+
+        TracePoint point = {static_cast<double>(transducer.coordinates.x.value()), static_cast<double>(transducer.coordinates.y.value())};
+        return point;
+    }
+};
+
+/* Roughly normal sensor noise with the given standard deviation */
+
+static double noise(HostRandom& random, double deviation) {
+    double sum = 0;
+
+    for (int i = 0; i < 12; i++)
+        sum += random.below(1000001) / 1000000.0;
+
+    return (sum - 6) * deviation;
+}
+
+static UInt32 quantise(double value) {
+    return value < 0 ? 0 : static_cast<UInt32>(value + 0.5);
+}
+
+struct TraceStatistics {
+    double raw_jitter;
+    double filtered_jitter;
+    double lag_ms;
+};
+
+/* Replays a straight line trace
+ * @speed The speed of the finger along X in logical units per second
+ * @deviation The standard deviation of the sensor noise
+ *
+ * The first half second is left for the filter to settle and is not measured.
+ */
+
+static TraceStatistics replayLine(double speed, double deviation, UInt32 seed) {
+    HostRandom random(seed);
+    FilterReplay replay;
+
+    double raw_error = 0;
+    double filtered_error = 0;
+    double lag = 0;
+    double lag_squares = 0;
+    int measured = 0;
+
+    for (int frame = 0; frame < 600; frame++) {
+        uint64_t timestamp = TRACE_START_NS + frame * FRAME_INTERVAL_NS;
+        double t = frame * FRAME_INTERVAL_NS / 1e9;
+
+        double x = 1000 + speed * t;
+        double y = 1000;
+
+        UInt32 raw_x = quantise(x + noise(random, deviation));
+        UInt32 raw_y = quantise(y + noise(random, deviation));
+
+        TracePoint filtered = replay.sample(timestamp, raw_x, raw_y);
+
+        if (frame < 60)
+            continue;
+
+        raw_error += (raw_y - y) * (raw_y - y);
+        filtered_error += (filtered.y - y) * (filtered.y - y);
+
+        lag += x - filtered.x;
+        lag_squares += (x - filtered.x) * (x - filtered.x);
+        measured++;
+    }
+
+    TraceStatistics statistics;
+    statistics.raw_jitter = sqrt(raw_error / measured);
+    statistics.filtered_jitter = sqrt(filtered_error / measured);
+    statistics.lag_ms = speed ? (lag / measured) / speed * 1000 : 0;
+
+    return statistics;
+}
+
+static void testJitter(HostTest& test, bool benchmark) {
+    // A resting finger on a cheap touch pad jitters by a couple of logical units
+    TraceStatistics resting = replayLine(0, 2.0, 32);
+
+    HOST_CHECK(test, resting.raw_jitter > 1.5);
+    HOST_CHECK(test, resting.filtered_jitter * 3 < resting.raw_jitter);
+
+    if (benchmark)
+        printf("resting finger: jitter %.2f raw, %.2f filtered\n", resting.raw_jitter, resting.filtered_jitter);
+
+    // The filter adapts, the faster the finger the less it lags in time
+    const double speeds[] = {200, 1000, 5000, 20000};
+    double previous_lag_ms = 1e9;
+
+    for (int i = 0; i < 4; i++) {
+        TraceStatistics moving = replayLine(speeds[i], 2.0, 320 + i);
+
+        HOST_CHECK(test, moving.lag_ms >= 0);
+        HOST_CHECK(test, moving.lag_ms <= previous_lag_ms);
+
+        if (benchmark)
+            printf("finger at %.0f units/s: %.2f ms added latency, jitter %.2f raw, %.2f filtered\n", speeds[i], moving.lag_ms, moving.raw_jitter, moving.filtered_jitter);
+
+        previous_lag_ms = moving.lag_ms;
+    }
+
+    // A fast swipe lags by less than one frame
+    TraceStatistics swipe = replayLine(20000, 2.0, 33);
+    HOST_CHECK(test, swipe.lag_ms < FRAME_INTERVAL_NS / 1e6);
+}
+
+static void testResets(HostTest& test) {
+    FilterReplay replay;
+    uint64_t timestamp = TRACE_START_NS;
+
+    // The first sample of a contact is passed through untouched
+    TracePoint point = replay.sample(timestamp, 500, 700);
+    HOST_CHECK(test, point.x == 500 && point.y == 700);
+
+    timestamp += FRAME_INTERVAL_NS;
+    point = replay.sample(timestamp, 510, 700);
+    HOST_CHECK(test, point.x > 500 && point.x < 510);
+
+    // A new contact in the same slot starts over
+    replay.transducer.secondary_id = 1;
+    timestamp += FRAME_INTERVAL_NS;
+    point = replay.sample(timestamp, 3000, 100);
+    HOST_CHECK(test, point.x == 3000 && point.y == 100);
+
+    // As does a finger that was lifted
+    timestamp += FRAME_INTERVAL_NS;
+    replay.sample(timestamp, 3000, 100, false);
+    timestamp += FRAME_INTERVAL_NS;
+    point = replay.sample(timestamp, 10, 20);
+    HOST_CHECK(test, point.x == 10 && point.y == 20);
+
+    // Or one that went quiet for longer than the filter remembers
+    timestamp += SMOOTHING_FILTER_MAX_INTERVAL_NS + 1;
+    point = replay.sample(timestamp, 4000, 4000);
+    HOST_CHECK(test, point.x == 4000 && point.y == 4000);
+
+    // A disabled filter leaves everything alone
+    replay.filter.enabled = false;
+    timestamp += FRAME_INTERVAL_NS;
+    point = replay.sample(timestamp, 0, 0);
+    HOST_CHECK(test, point.x == 0 && point.y == 0);
+
+    // Coordinates at the top of the logical range do not overflow
+    replay.filter.enabled = true;
+    replay.filter.configure(SMOOTHING_FILTER_DEFAULT_MIN_CUTOFF, SMOOTHING_FILTER_DEFAULT_BETA, SMOOTHING_FILTER_DEFAULT_DERIVATIVE_CUTOFF);
+
+    for (int i = 0; i < 100; i++) {
+        timestamp += FRAME_INTERVAL_NS;
+        point = replay.sample(timestamp, i % 2 ? 0xFFFF : 0, 0xFFFF);
+        HOST_CHECK(test, point.x <= 0xFFFF && point.y == 0xFFFF);
+    }
+}
+
+static void benchmarkContacts() {
+    VoodooI2CHIDSmoothingFilter filter;
+    VoodooI2CDigitiserTransducer transducers[10];
+    OSArray* array = OSArray::withCapacity(10);
+    HostRandom random(32);
+
+    filter.enabled = true;
+
+    for (int i = 0; i < 10; i++) {
+        transducers[i].secondary_id = i;
+        transducers[i].tip_switch.update(1, 0);
+        array->setObject(&transducers[i]);
+    }
+
+    VoodooI2CHIDInputFrame frame;
+    frame.report = NULL;
+    frame.report_type = kIOHIDReportTypeInput;
+    frame.report_id = 0;
+    frame.event.transducers = array;
+    frame.event.contact_count = 10;
+
+    double ns = hostBenchmark(100000, [&](int i) {
+        frame.timestamp = TRACE_START_NS + i * FRAME_INTERVAL_NS;
+
+        for (int j = 0; j < 10; j++) {
+            transducers[j].coordinates.x.update(1000 + j * 100 + random.below(5), frame.timestamp);
+            transducers[j].coordinates.y.update(1000 + random.below(5), frame.timestamp);
+        }
+
+        filter.processFrame(frame);
+    });
+
+    printf("smoothing filter: %.1f ns per frame of 10 contacts\n", ns);
+
+    delete array;
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testJitter(test, test.benchmark);
+    testResets(test);
+
+    if (test.benchmark)
+        benchmarkContacts();
+
+    return test.finish("VoodooI2CHIDSmoothingFilterTests");
+}
@@ -0,0 +1,228 @@
+//
+//  VoodooI2CHIDStylusButtonStateMachineTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDStylusButtonStateMachine.hpp"
+
+/* Replays the switch sequences that known pen firmware reports through the stylus button state machine
+ *
+ * Every entry of the matrix is a stroke as one kind of firmware reports it, scanned every 7.5 ms, along with the buttons
+ * the driver has to report for each frame.
+ */
+
+#define FRAME_INTERVAL_NS 7500000ULL
+#define TRACE_START_NS    1000000000ULL
+#define MAX_FRAMES        8
+
+#define NONE   0
+#define TIP    STYLUS_BUTTON_TIP
+#define BARREL STYLUS_BUTTON_BARREL
+#define ERASER STYLUS_BUTTON_ERASER
+
+struct PenFrame {
+    bool tip;
+    bool barrel;
+    bool eraser;
+    bool invert;
+    UInt32 buttons;
+};
+
+struct PenFirmwareCase {
+    const char* name;
+    UInt32 debounce_ms;
+    int frame_count;
+    PenFrame frames[MAX_FRAMES];
+};
+
+static const PenFirmwareCase firmware_matrix[] = {
+    {"tip stroke", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 4, {
+        {0, 0, 0, 0, NONE},
+        {1, 0, 0, 0, TIP},
+        {1, 0, 0, 0, TIP},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"barrel held as the tip lands drags with the barrel", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 7, {
+        {0, 1, 0, 0, NONE},
+        {0, 1, 0, 0, NONE},
+        {0, 1, 0, 0, BARREL},
+        {1, 1, 0, 0, BARREL},
+        {1, 0, 0, 0, BARREL},
+        {0, 0, 0, 0, BARREL},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"barrel pressed mid stroke keeps the tip drag", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 5, {
+        {1, 0, 0, 0, TIP},
+        {1, 1, 0, 0, TIP},
+        {1, 1, 0, 0, TIP},
+        {1, 1, 0, 0, TIP},
+        {0, 1, 0, 0, BARREL}
+    }},
+    {"barrel clicked while hovering", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 6, {
+        {0, 1, 0, 0, NONE},
+        {0, 1, 0, 0, NONE},
+        {0, 1, 0, 0, BARREL},
+        {0, 0, 0, 0, BARREL},
+        {0, 0, 0, 0, BARREL},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"bouncing barrel switch", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 5, {
+        {0, 1, 0, 0, NONE},
+        {0, 0, 0, 0, NONE},
+        {0, 1, 0, 0, NONE},
+        {0, 0, 0, 0, NONE},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"eraser reported with Invert and Eraser", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 5, {
+        {0, 0, 0, 1, NONE},
+        {0, 0, 0, 1, NONE},
+        {0, 0, 1, 1, ERASER},
+        {0, 0, 1, 1, ERASER},
+        {0, 0, 0, 1, NONE}
+    }},
+    {"eraser reported with Invert and Tip Switch", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 6, {
+        {0, 0, 0, 1, NONE},
+        {0, 0, 0, 1, NONE},
+        {0, 0, 0, 1, NONE},
+        {1, 0, 0, 1, ERASER},
+        {1, 0, 0, 1, ERASER},
+        {0, 0, 0, 1, NONE}
+    }},
+    {"Invert cleared as the eraser touches", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 7, {
+        {0, 0, 0, 1, NONE},
+        {0, 0, 0, 1, NONE},
+        {0, 0, 0, 1, NONE},
+        {1, 0, 0, 0, ERASER},
+        {1, 0, 0, 0, ERASER},
+        {1, 0, 0, 0, ERASER},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"eraser without an Invert usage", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 3, {
+        {0, 0, 1, 0, ERASER},
+        {0, 0, 1, 0, ERASER},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"Tip Switch reported along with Eraser", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 3, {
+        {1, 0, 1, 0, ERASER},
+        {1, 0, 1, 0, ERASER},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"Invert glitching mid stroke", STYLUS_BUTTON_DEFAULT_DEBOUNCE, 4, {
+        {1, 0, 0, 0, TIP},
+        {1, 0, 0, 1, TIP},
+        {1, 0, 0, 0, TIP},
+        {0, 0, 0, 0, NONE}
+    }},
+    {"no debounce", 0, 3, {
+        {0, 1, 0, 0, BARREL},
+        {1, 1, 0, 0, BARREL},
+        {0, 0, 0, 0, NONE}
+    }}
+};
+
+static void testFirmwareMatrix(HostTest& test) {
+    for (size_t i = 0; i < sizeof(firmware_matrix) / sizeof(firmware_matrix[0]); i++) {
+        const PenFirmwareCase& entry = firmware_matrix[i];
+        VoodooI2CHIDStylusButtonStateMachine machine;
+        int mismatches = 0;
+
+        machine.configure(entry.debounce_ms);
+
+        for (int frame = 0; frame < entry.frame_count; frame++) {
+            const PenFrame& switches = entry.frames[frame];
+            UInt32 buttons = machine.update(switches.tip, switches.barrel, switches.eraser, switches.invert, TRACE_START_NS + frame * FRAME_INTERVAL_NS);
+
+            if (buttons != switches.buttons)
+                mismatches++;
+        }
+
+        if (mismatches)
+            printf("%s: %d frames with the wrong buttons\n", entry.name, mismatches);
+
+        HOST_CHECK(test, mismatches == 0);
+    }
+}
+
+static void testReset(HostTest& test) {
+    VoodooI2CHIDStylusButtonStateMachine machine;
+    machine.configure(STYLUS_BUTTON_DEFAULT_DEBOUNCE);
+
+    for (int frame = 0; frame < 3; frame++)
+        machine.update(0, 1, 0, 0, TRACE_START_NS + frame * FRAME_INTERVAL_NS);
+
+    HOST_CHECK(test, machine.getState() == kVoodooI2CHIDStylusHoverBarrel);
+
+    // A barrel switch held before the pen left range does not make the next stroke a barrel drag
+    machine.reset();
+    HOST_CHECK(test, machine.update(1, 0, 0, 0, TRACE_START_NS + 3 * FRAME_INTERVAL_NS) == TIP);
+
+    // A timestamp going backwards takes the pending switches rather than holding them forever
+    machine.reset();
+    HOST_CHECK(test, machine.update(0, 1, 0, 0, TRACE_START_NS) == NONE);
+    HOST_CHECK(test, machine.update(0, 1, 0, 0, TRACE_START_NS - FRAME_INTERVAL_NS) == BARREL);
+}
+
+static void testRandomSwitches(HostTest& test) {
+    VoodooI2CHIDStylusButtonStateMachine machine;
+    HostRandom random(48);
+    int invalid = 0;
+    int eraser_with_tip_lifted = 0;
+
+    machine.configure(STYLUS_BUTTON_DEFAULT_DEBOUNCE);
+
+    for (int frame = 0; frame < 1000000; frame++) {
+        UInt32 switches = random.below(16);
+        bool tip = switches & 0x1;
+        bool eraser = switches & 0x4;
+
+        UInt32 buttons = machine.update(tip, switches & 0x2, eraser, switches & 0x8, TRACE_START_NS + frame * FRAME_INTERVAL_NS);
+
+        // At most one button at a time, whatever the firmware sends
+        if (buttons != NONE && buttons != TIP && buttons != BARREL && buttons != ERASER)
+            invalid++;
+
+        // The eraser is only ever down while something touches
+        if (buttons == ERASER && !tip && !eraser)
+            eraser_with_tip_lifted++;
+    }
+
+    HOST_CHECK(test, invalid == 0);
+    HOST_CHECK(test, eraser_with_tip_lifted == 0);
+}
+
+static void benchmark() {
+    VoodooI2CHIDStylusButtonStateMachine machine;
+    HostRandom random(48);
+    UInt8 switches[4096];
+
+    machine.configure(STYLUS_BUTTON_DEFAULT_DEBOUNCE);
+
+    for (int i = 0; i < 4096; i++)
+        switches[i] = random.below(16);
+
+    volatile UInt32 sink = 0;
+
+    double ns = hostBenchmark(10000000, [&](int i) {
+        UInt8 frame = switches[i & 4095];
+        sink = sink + machine.update(frame & 0x1, frame & 0x2, frame & 0x4, frame & 0x8, TRACE_START_NS + i * FRAME_INTERVAL_NS);
+    });
+
+    printf("stylus button state machine: %.2f ns per frame\n", ns);
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testFirmwareMatrix(test);
+    testReset(test);
+    testRandomSwitches(test);
+
+    if (test.benchmark)
+        benchmark();
+
+    return test.finish("VoodooI2CHIDStylusButtonStateMachineTests");
+}
@@ -0,0 +1,291 @@
+//
+//  VoodooI2CHIDTouchPredictorTests.cpp
+//  VoodooI2CHID Tests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include <math.h>
+
+#include "HostTest.hpp"
+#include "VoodooI2CHIDTouchPredictor.hpp"
+
+/* Replays finger traces through the touch predictor and scores every prediction against the sample that actually
+ * arrives one prediction interval later
+ *
+ * The score of a trace is compared with the error of not predicting at all, which is how far the finger moves during
+ * the interval. The traces are scanned at 120 Hz and predicted three frames ahead.
+ */
+
+#define FRAME_INTERVAL_NS 8333333ULL
+#define TRACE_START_NS    1000000000ULL
+#define TRACE_FRAMES      480
+#define HORIZON_FRAMES    3
+#define HORIZON_MS        25
+#define LOGICAL_MAX       65535
+
+enum TraceShape {
+    kTraceLine,
+    kTraceAcceleration,
+    kTraceCircle,
+    kTraceReversal
+};
+
+static const char* const shape_names[] = {"line", "acceleration", "circle", "reversal"};
+
+struct TracePoint {
+    double x;
+    double y;
+};
+
+static TracePoint tracePosition(TraceShape shape, double t) {
+    TracePoint point;
+
+    switch (shape) {
+        case kTraceLine:
+            point.x = 5000 + 3000 * t;
+            point.y = 5000 + 1500 * t;
+            break;
+        case kTraceAcceleration:
+            point.x = 5000 + 2000 * t * t;
+            point.y = 5000;
+            break;
+        case kTraceCircle:
+            point.x = 20000 + 4000 * cos(2 * M_PI * t);
+            point.y = 20000 + 4000 * sin(2 * M_PI * t);
+            break;
+        default:
+            // Back and forth twice a second, the turns are where prediction overshoots
+            point.x = 20000 + 3000 * sin(4 * M_PI * t);
+            point.y = 20000;
+            break;
+    }
+
+    return point;
+}
+
+struct PredictionScore {
+    double predicted_error;
+    double unpredicted_error;
+    double overshoot;
+};
+
+/* Replays a trace
+ * @shape The path of the finger
+ * @arrival_jitter_ns How far the timestamp given to the predictor strays from the scan time, 0 to use the scan time
+ * @seed Seeds the sensor noise and the jitter
+ */
+
+static PredictionScore replayTrace(TraceShape shape, uint64_t arrival_jitter_ns, UInt32 seed) {
+    HostRandom random(seed);
+    VoodooI2CHIDTouchPredictor predictor;
+    VoodooI2CDigitiserTransducer transducer;
+    OSArray* transducers = OSArray::withCapacity(1);
+
+    transducers->setObject(&transducer);
+    transducer.logical_max_x = LOGICAL_MAX;
+    transducer.logical_max_y = LOGICAL_MAX;
+
+    predictor.enabled = true;
+    predictor.interval_ms = HORIZON_MS;
+
+    TracePoint samples[TRACE_FRAMES];
+    TracePoint predictions[TRACE_FRAMES];
+
+    for (int frame = 0; frame < TRACE_FRAMES; frame++) {
+        uint64_t scan_time = TRACE_START_NS + frame * FRAME_INTERVAL_NS;
+        TracePoint position = tracePosition(shape, frame * FRAME_INTERVAL_NS / 1e9);
+
+        // One logical unit of sensor noise
+        samples[frame].x = floor(position.x + random.below(3)) - 1;
+        samples[frame].y = floor(position.y + random.below(3)) - 1;
+
+        VoodooI2CHIDInputFrame input;
+        input.timestamp = scan_time;
+        input.report = NULL;
+        input.report_type = kIOHIDReportTypeInput;
+        input.report_id = 0;
+        input.event.transducers = transducers;
+        input.event.contact_count = 1;
+
+        if (arrival_jitter_ns)
+            input.timestamp += random.below(static_cast<UInt32>(arrival_jitter_ns));
+
+        transducer.tip_switch.update(1, input.timestamp);
+        transducer.coordinates.x.update(static_cast<UInt32>(samples[frame].x), input.timestamp);
+        transducer.coordinates.y.update(static_cast<UInt32>(samples[frame].y), input.timestamp);
+
+        predictor.processFrame(input);
+
+        predictions[frame].x = transducer.coordinates.x.value();
+        predictions[frame].y = transducer.coordinates.y.value();
+    }
+
+    delete transducers;
+
+    PredictionScore score = {};
+    int scored = 0;
+
+    // The first frames are left for the estimate to settle
+    for (int frame = 10; frame + HORIZON_FRAMES < TRACE_FRAMES; frame++) {
+        const TracePoint& future = samples[frame + HORIZON_FRAMES];
+
+        score.predicted_error += hypot(predictions[frame].x - future.x, predictions[frame].y - future.y);
+        score.unpredicted_error += hypot(samples[frame].x - future.x, samples[frame].y - future.y);
+        scored++;
+
+        // How far past the furthest point of the trace the prediction went
+        if (shape == kTraceReversal) {
+            double beyond = fabs(predictions[frame].x - 20000) - 3000;
+
+            if (beyond > score.overshoot)
+                score.overshoot = beyond;
+        }
+    }
+
+    score.predicted_error /= scored;
+    score.unpredicted_error /= scored;
+
+    return score;
+}
+
+static void testPredictionError(HostTest& test, bool benchmark) {
+    // The smaller the share of the motion left as error, the better the prediction
+    const double limits[] = {0.1, 0.1, 0.1, 0.3};
+
+    for (int shape = kTraceLine; shape <= kTraceReversal; shape++) {
+        PredictionScore score = replayTrace(static_cast<TraceShape>(shape), 0, 33 + shape);
+
+        HOST_CHECK(test, score.predicted_error < score.unpredicted_error * limits[shape]);
+
+        if (benchmark)
+            printf("%s: %.1f units predicted, %.1f units without prediction\n", shape_names[shape], score.predicted_error, score.unpredicted_error);
+    }
+
+    // Damping keeps the turns from being thrown far past where the finger actually turned
+    PredictionScore reversal = replayTrace(kTraceReversal, 0, 330);
+    double travel = 3000 * 4 * M_PI * HORIZON_MS / 1000.0;
+
+    HOST_CHECK(test, reversal.overshoot < travel * 0.25);
+
+    if (benchmark)
+        printf("reversal: %.1f units past the turn, %.1f units of travel in an interval at full speed\n", reversal.overshoot, travel);
+}
+
+static void testScanTime(HostTest& test, bool benchmark) {
+    // Timestamps taken on arrival carry the bus and work loop jitter into the velocity estimate
+    PredictionScore scan_time = replayTrace(kTraceCircle, 0, 331);
+    PredictionScore arrival_time = replayTrace(kTraceCircle, 4000000, 331);
+
+    HOST_CHECK(test, scan_time.predicted_error < arrival_time.predicted_error);
+
+    if (benchmark)
+        printf("circle: %.1f units with scan time, %.1f units with 4 ms of arrival jitter\n", scan_time.predicted_error, arrival_time.predicted_error);
+}
+
+static void testResets(HostTest& test) {
+    VoodooI2CHIDTouchPredictor predictor;
+    VoodooI2CDigitiserTransducer transducer;
+    OSArray* transducers = OSArray::withCapacity(1);
+
+    transducers->setObject(&transducer);
+    transducer.logical_max_x = 1000;
+    transducer.logical_max_y = 1000;
+
+    predictor.enabled = true;
+    predictor.interval_ms = HORIZON_MS;
+
+    VoodooI2CHIDInputFrame input;
+    input.report = NULL;
+    input.report_type = kIOHIDReportTypeInput;
+    input.report_id = 0;
+    input.event.transducers = transducers;
+    input.event.contact_count = 1;
+
+    // A fast finger heading for the edge is never predicted past it
+    for (int frame = 0; frame < 10; frame++) {
+        input.timestamp = TRACE_START_NS + frame * FRAME_INTERVAL_NS;
+        transducer.tip_switch.update(1, input.timestamp);
+        transducer.coordinates.x.update(900 + frame * 10, input.timestamp);
+        transducer.coordinates.y.update(100 - frame * 10, input.timestamp);
+
+        predictor.processFrame(input);
+
+        HOST_CHECK(test, transducer.coordinates.x.value() <= 1000);
+        HOST_CHECK(test, transducer.coordinates.y.value() <= 1000);
+    }
+
+    HOST_CHECK(test, transducer.coordinates.x.value() == 1000);
+    HOST_CHECK(test, transducer.coordinates.y.value() == 0);
+
+    // A new contact in the slot is not predicted from the old one
+    transducer.secondary_id = 1;
+    input.timestamp += FRAME_INTERVAL_NS;
+    transducer.coordinates.x.update(500, input.timestamp);
+    transducer.coordinates.y.update(500, input.timestamp);
+    predictor.processFrame(input);
+
+    HOST_CHECK(test, transducer.coordinates.x.value() == 500 && transducer.coordinates.y.value() == 500);
+
+    // Neither is the same one after a long pause
+    input.timestamp += TOUCH_PREDICTOR_MAX_SAMPLE_NS + 1;
+    transducer.coordinates.x.update(600, input.timestamp);
+    transducer.coordinates.y.update(600, input.timestamp);
+    predictor.processFrame(input);
+
+    HOST_CHECK(test, transducer.coordinates.x.value() == 600 && transducer.coordinates.y.value() == 600);
+
+    delete transducers;
+}
+
+static void benchmarkContacts() {
+    VoodooI2CHIDTouchPredictor predictor;
+    VoodooI2CDigitiserTransducer transducers[10];
+    OSArray* array = OSArray::withCapacity(10);
+
+    predictor.enabled = true;
+
+    for (int i = 0; i < 10; i++) {
+        transducers[i].secondary_id = i;
+        transducers[i].logical_max_x = LOGICAL_MAX;
+        transducers[i].logical_max_y = LOGICAL_MAX;
+        transducers[i].tip_switch.update(1, 0);
+        array->setObject(&transducers[i]);
+    }
+
+    VoodooI2CHIDInputFrame frame;
+    frame.report = NULL;
+    frame.report_type = kIOHIDReportTypeInput;
+    frame.report_id = 0;
+    frame.event.transducers = array;
+    frame.event.contact_count = 10;
+
+    double ns = hostBenchmark(100000, [&](int i) {
+        frame.timestamp = TRACE_START_NS + i * FRAME_INTERVAL_NS;
+
+        for (int j = 0; j < 10; j++) {
+            transducers[j].coordinates.x.update(1000 + (i * 7 + j * 100) % 30000, frame.timestamp);
+            transducers[j].coordinates.y.update(1000 + (i * 3) % 30000, frame.timestamp);
+        }
+
+        predictor.processFrame(frame);
+    });
+
+    printf("touch predictor: %.1f ns per frame of 10 contacts\n", ns);
+
+    delete array;
+}
+
+int main(int argc, char** argv) {
+    HostTest test(argc, argv);
+
+    testPredictionError(test, test.benchmark);
+    testScanTime(test, test.benchmark);
+    testResets(test);
+
+    if (test.benchmark)
+        benchmarkContacts();
+
+    return test.finish("VoodooI2CHIDTouchPredictorTests");
+}
@@ -12,33 +12,6 @@
 #define super VoodooI2CSensor
 OSDefineMetaClassAndStructors(VoodooI2CAccelerometerSensor, VoodooI2CSensor);
 
-IOFramebuffer* VoodooI2CAccelerometerSensor::getFramebuffer() {
-    IORegistryEntry* display = NULL;
-    IOFramebuffer* framebuffer = NULL;
-    
-    OSDictionary *match = serviceMatching("IODisplay");
-    OSIterator *iterator = getMatchingServices(match);
-    
-    if (iterator) {
-        display = OSDynamicCast(IORegistryEntry, iterator->getNextObject());
-        
-        if (display) {
-            IOLog("%s::Got active display\n", getName());
-            IORegistryEntry *entry = display->getParentEntry(gIOServicePlane)->getParentEntry(gIOServicePlane);
-            if (entry)
-                framebuffer = reinterpret_cast<IOFramebuffer*>(entry->metaCast("IOFramebuffer"));
-            if (framebuffer)
-                IOLog("%s::Got active framebuffer\n", getName());
-        }
-        
-        iterator->release();
-    }
-    
-    OSSafeReleaseNULL(match);
-
-    return framebuffer;
-}
-
 void VoodooI2CAccelerometerSensor::handleInterruptReport(AbsoluteTime timestamp, IOMemoryDescriptor* report, IOHIDReportType report_type, UInt32 report_id) {
     if (!x_axis || !y_axis || !z_axis)
         return;
@@ -46,9 +19,6 @@ void VoodooI2CAccelerometerSensor::handleInterruptReport(AbsoluteTime timestamp,
     if (x_axis->getReportID() != report_id)
         return;
 
-    if (!active_framebuffer)
-        active_framebuffer = getFramebuffer();
-    
     SInt16 x_axis_value = *(SInt16*)x_axis->getDataValue()->getBytesNoCopy();
     SInt16 y_axis_value = *(SInt16*)y_axis->getDataValue()->getBytesNoCopy();
     SInt16 z_axis_value = *(SInt16*)z_axis->getDataValue()->getBytesNoCopy();
@@ -77,16 +47,51 @@ void VoodooI2CAccelerometerSensor::handleInterruptReport(AbsoluteTime timestamp,
         rotateDevice(rotation_state);
 }
 
+bool VoodooI2CAccelerometerSensor::notificationDisplayHandler(void* refCon, IOService* newService, IONotifier* notifier) {
+    command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CAccelerometerSensor::notificationDisplayHandlerGated), newService, notifier);
+
+    return true;
+}
+
+IOReturn VoodooI2CAccelerometerSensor::notificationDisplayHandlerGated(IOService* newService, IONotifier* notifier) {
+    if (notifier == display_terminate_notify) {
+        if (!display_binding.release(newService))
+            return kIOReturnSuccess;
+
+        display_binding.rescan();
+    } else if (!display_binding.offer(newService)) {
+        return kIOReturnSuccess;
+    }
+
+    if (display_binding.getFramebuffer())
+        IOLog("%s::Got active framebuffer\n", getName());
+
+    // The next report applies the orientation to the display we are bound to now
+    current_rotation = kIOScaleRotate0;
+
+    return kIOReturnSuccess;
+}
+
 void VoodooI2CAccelerometerSensor::rotateDevice(IOOptionBits rotation_state) {
+    if (command_gate)
+        command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CAccelerometerSensor::rotateDeviceGated), &rotation_state);
+}
+
+IOReturn VoodooI2CAccelerometerSensor::rotateDeviceGated(IOOptionBits* rotation_state) {
+    // The terminate notification releases the framebuffer under the same gate, so it stays alive until we are done
+    IOFramebuffer* active_framebuffer = display_binding.getFramebuffer();
+
     if (!active_framebuffer)
-        return;
+        return kIOReturnNotReady;
     
-    if (rotation_state == kIOScaleRotateFlat)
-        return;
+    if (*rotation_state == kIOScaleRotateFlat)
+        return kIOReturnSuccess;
 
-    active_framebuffer->requestProbe(kIOFBSetTransform | (rotation_state) << 16);
+    active_framebuffer->requestProbe(kIOFBSetTransform | (*rotation_state) << 16);
 
-    current_rotation = rotation_state;
+    current_rotation = *rotation_state;
+
+    return kIOReturnSuccess;
 }
 
 IOReturn VoodooI2CAccelerometerSensor::setPowerState(unsigned long whichState, IOService* whatDevice) {
@@ -145,11 +150,60 @@ bool VoodooI2CAccelerometerSensor::start(IOService* provider) {
         setElementValue(change_sensitivity, 3);
     }
 
-    active_framebuffer = getFramebuffer();
+    work_loop = getWorkLoop();
+
+    if (!work_loop)
+        return false;
+
+    work_loop->retain();
+
+    command_gate = IOCommandGate::commandGate(this);
+
+    if (!command_gate || work_loop->addEventSource(command_gate) != kIOReturnSuccess) {
+        OSSafeReleaseNULL(command_gate);
+        OSSafeReleaseNULL(work_loop);
+        return false;
+    }
+
+    display_binding.configure(OSDynamicCast(OSDictionary, provider->getProperty(kDisplayBindingKey)));
+
+    // Displays that are already published are delivered right away
+    OSDictionary* matching = serviceMatching("IODisplay");
+
+    if (matching) {
+        IOServiceMatchingNotificationHandler handler = OSMemberFunctionCast(IOServiceMatchingNotificationHandler, this, &VoodooI2CAccelerometerSensor::notificationDisplayHandler);
+
+        display_publish_notify = addMatchingNotification(gIOFirstPublishNotification, matching, handler, this, NULL);
+        display_terminate_notify = addMatchingNotification(gIOTerminatedNotification, matching, handler, this, NULL);
+        OSSafeReleaseNULL(matching);
+    }
     
     return true;
 }
 
+void VoodooI2CAccelerometerSensor::stop(IOService* provider) {
+    if (display_publish_notify) {
+        display_publish_notify->remove();
+        display_publish_notify = NULL;
+    }
+
+    if (display_terminate_notify) {
+        display_terminate_notify->remove();
+        display_terminate_notify = NULL;
+    }
+
+    display_binding.reset();
+
+    if (command_gate) {
+        work_loop->removeEventSource(command_gate);
+        OSSafeReleaseNULL(command_gate);
+    }
+
+    OSSafeReleaseNULL(work_loop);
+
+    super::stop(provider);
+}
+
 VoodooI2CSensor* VoodooI2CAccelerometerSensor::withElement(IOHIDElement* sensor_element, IOService* event_driver) {
     VoodooI2CSensor* sensor = OSTypeAlloc(VoodooI2CAccelerometerSensor);
     
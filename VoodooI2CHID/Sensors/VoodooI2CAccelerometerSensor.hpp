@@ -10,14 +10,17 @@
 #define VoodooI2CAccelerometerSensor_hpp
 
 #include <IOKit/IOLib.h>
+#include <IOKit/IOCommandGate.h>
 #include <IOKit/IOKitKeys.h>
 #include <IOKit/IOService.h>
+#include <IOKit/IOWorkLoop.h>
 
 #include <IOKit/graphics/IODisplay.h>
 #include <IOKit/graphics/IOFramebuffer.h>
 #include <IOKit/graphics/IOGraphicsTypes.h>
 
 #include "VoodooI2CSensor.hpp"
+#include "../VoodooI2CHIDDisplayBinding.hpp"
 
 #define kIOFBTransformKey               "IOFBTransform"
 
@@ -37,20 +40,39 @@ class EXPORT VoodooI2CAccelerometerSensor : public VoodooI2CSensor {
     void rotateDevice(IOOptionBits rotation_state);
     IOReturn setPowerState(unsigned long whichState, IOService* whatDevice);
     bool start(IOService* provider);
+    void stop(IOService* provider);
     static VoodooI2CSensor* withElement(IOHIDElement* sensor_element, IOService* event_driver);
 
  protected:
  private:
-    IOFramebuffer* active_framebuffer;
+    IOWorkLoop* work_loop = NULL;
+    IOCommandGate* command_gate = NULL;
+
+    VoodooI2CHIDDisplayBinding display_binding;     // Only used under the gate, display termination drops its framebuffer
     UInt8 current_rotation = kIOScaleRotate0;
-    
+
+    IONotifier* display_publish_notify = NULL;
+    IONotifier* display_terminate_notify = NULL;
     
     IOHIDElement* change_sensitivity;
     IOHIDElement* x_axis;
     IOHIDElement* y_axis;
     IOHIDElement* z_axis;
 
-    IOFramebuffer* getFramebuffer();
+    bool notificationDisplayHandler(void* refCon, IOService* newService, IONotifier* notifier);
+
+    /* Gated half of <notificationDisplayHandler>
+     * @newService The display
+     * @notifier IONotifier object for the notification registration
+     */
+
+    IOReturn notificationDisplayHandlerGated(IOService* newService, IONotifier* notifier);
+
+    /* Gated half of <rotateDevice>
+     * @rotation_state Pointer to the orientation to apply
+     */
+
+    IOReturn rotateDeviceGated(IOOptionBits* rotation_state);
 };
 
 
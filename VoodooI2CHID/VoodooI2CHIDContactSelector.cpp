@@ -0,0 +1,66 @@
+//
+//  VoodooI2CHIDContactSelector.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDContactSelector.hpp"
+
+void VoodooI2CHIDContactSelector::select(VoodooI2CMultitouchEvent& event, OSArray* selection) {
+    VoodooI2CDigitiserTransducer* selected[CONTACT_SELECTOR_MAX_CONTACTS];
+    UInt32 scores[CONTACT_SELECTOR_MAX_CONTACTS];
+    UInt8 selected_count = 0;
+    UInt8 limit = max_contacts < CONTACT_SELECTOR_MAX_CONTACTS ? max_contacts : CONTACT_SELECTOR_MAX_CONTACTS;
+
+    for (int index = 0, count = event.transducers->getCount(); limit && index < count && index < event.contact_count; index++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(index));
+
+        if (!transducer || transducer->type != kDigitiserTransducerFinger)
+            continue;
+
+        // Confident contacts first, then the ones the engines already know about so that they also see them lift,
+        // then touching ones, and the smallest among equals since palms are large
+        UInt32 identifier_bit = 1U << (transducer->secondary_id & 31);
+        uint64_t area = static_cast<uint64_t>(transducer->dimensions.width.value()) * transducer->dimensions.height.value();
+        UInt32 score = area < 0x1FFFFFFF ? 0x1FFFFFFF - static_cast<UInt32>(area) : 0;
+
+        if (transducer->is_valid)
+            score |= 1U << 31;
+        if (forwarded_identifiers & identifier_bit)
+            score |= 1U << 30;
+        if (transducer->tip_switch.value())
+            score |= 1U << 29;
+
+        // Insert into the sorted selection, dropping the weakest contact once it is full
+        int position = selected_count;
+
+        while (position > 0 && scores[position - 1] < score)
+            position--;
+
+        if (position >= limit)
+            continue;
+
+        int last = selected_count < limit ? selected_count : limit - 1;
+
+        for (int i = last; i > position; i--) {
+            selected[i] = selected[i - 1];
+            scores[i] = scores[i - 1];
+        }
+
+        selected[position] = transducer;
+        scores[position] = score;
+
+        if (selected_count < limit)
+            selected_count++;
+    }
+
+    selection->flushCollection();
+
+    for (int i = 0; i < selected_count; i++)
+        selection->setObject(selected[i]);
+
+    event.transducers = selection;
+    event.contact_count = selected_count;
+}
@@ -0,0 +1,50 @@
+//
+//  VoodooI2CHIDContactSelector.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDContactSelector_hpp
+#define VoodooI2CHIDContactSelector_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+
+#include "../../../Multitouch Support/VoodooI2CDigitiserTransducer.hpp"
+#include "../../../Multitouch Support/MultitouchHelpers.hpp"
+
+#define CONTACT_SELECTOR_MAX_CONTACTS 10
+
+/* Narrows a frame with more contacts than the gesture engines handle down to the most confident ones
+ *
+ * Contacts with their confidence bit set win, then those that were forwarded in the previous frame so that the engines
+ * see them through to their lift, then touching ones and finally the smallest ones. The selection is a single insertion
+ * pass into at most <max_contacts> slots, linear in the number of contacts for a fixed limit.
+ */
+
+class VoodooI2CHIDContactSelector {
+ public:
+    UInt8 max_contacts = CONTACT_SELECTOR_MAX_CONTACTS;
+    UInt32 forwarded_identifiers = 0;       // Bit per Contact Identifier, set by the caller once a frame is forwarded
+
+    /* Checks whether a frame has to be narrowed
+     * @event The frame
+     *
+     * @return *true* if the frame has more contacts than <max_contacts>, *false* otherwise
+     */
+
+    bool needsSelection(const VoodooI2CMultitouchEvent& event) const { return event.contact_count > max_contacts; }
+
+    /* Selects the contacts of a frame
+     * @event The frame, its transducers are replaced by the selection
+     * @selection The array the selection is put in, sized for <max_contacts> up front so that refilling it does not
+     * allocate
+     */
+
+    void select(VoodooI2CMultitouchEvent& event, OSArray* selection);
+};
+
+
+#endif /* VoodooI2CHIDContactSelector_hpp */
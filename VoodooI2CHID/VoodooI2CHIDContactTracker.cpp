@@ -0,0 +1,147 @@
+//
+//  VoodooI2CHIDContactTracker.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDContactTracker.hpp"
+
+void VoodooI2CHIDContactTracker::configure(UInt8 maximum_contacts, UInt32 gate) {
+    if (!maximum_contacts || maximum_contacts > CONTACT_TRACKER_MAX_CONTACTS)
+        maximum_contacts = CONTACT_TRACKER_MAX_CONTACTS;
+
+    this->maximum_contacts = maximum_contacts;
+    this->gate = gate;
+    gate_squared = static_cast<uint64_t>(gate) * gate;
+
+    reset();
+}
+
+bool VoodooI2CHIDContactTracker::processFrame(VoodooI2CHIDInputFrame& frame) {
+    if (!enabled || !frame.event.transducers)
+        return true;
+
+    VoodooI2CDigitiserTransducer* contacts[CONTACT_TRACKER_MAX_CONTACTS];
+    SInt8 matches[CONTACT_TRACKER_MAX_CONTACTS];
+    bool matched_tracks[CONTACT_TRACKER_MAX_CONTACTS] = {};
+    UInt8 contact_count = 0;
+
+    // Digitisers without a contact count report every finger in every frame
+    UInt8 frame_contacts = maximum_contacts;
+
+    if (frame.event.contact_count && frame.event.contact_count < maximum_contacts)
+        frame_contacts = frame.event.contact_count;
+
+    // The contacts of a frame are the first fingers, anything past the contact count is left over from earlier frames
+    for (int i = 0; i < frame.event.transducers->getCount() && contact_count < frame_contacts; i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, frame.event.transducers->getObject(i));
+
+        if (!transducer || transducer->type != kDigitiserTransducerFinger)
+            continue;
+
+        matches[contact_count] = -1;
+        contacts[contact_count++] = transducer;
+    }
+
+    // Derive the gate from the size of the surface, an eighth of it is far more than a finger moves in a frame
+    if (!gate_squared && contact_count) {
+        uint64_t derived_gate = (contacts[0]->logical_max_x + contacts[0]->logical_max_y) / 8;
+        gate_squared = derived_gate * derived_gate;
+    }
+
+    // Greedily pair the closest contact and track until no pair is within the gate
+    for (;;) {
+        uint64_t best_distance = UINT64_MAX;
+        int best_contact = -1;
+        int best_track = -1;
+
+        for (int i = 0; i < contact_count; i++) {
+            if (matches[i] != -1)
+                continue;
+
+            for (int j = 0; j < track_count; j++) {
+                if (matched_tracks[j])
+                    continue;
+
+                SInt64 dx = static_cast<SInt64>(contacts[i]->coordinates.x.value()) - tracks[j].x;
+                SInt64 dy = static_cast<SInt64>(contacts[i]->coordinates.y.value()) - tracks[j].y;
+                uint64_t distance = dx * dx + dy * dy;
+
+                if (distance <= gate_squared && distance < best_distance) {
+                    best_distance = distance;
+                    best_contact = i;
+                    best_track = j;
+                }
+            }
+        }
+
+        if (best_contact == -1)
+            break;
+
+        matches[best_contact] = best_track;
+        matched_tracks[best_track] = true;
+    }
+
+    // A track left over once pairing stops is further than the gate from every contact that is still unmatched
+    bool unmatched_tracks = false;
+
+    for (int j = 0; j < track_count; j++)
+        unmatched_tracks |= !matched_tracks[j];
+
+    // Hand out identifiers, matched contacts first so that new ones can avoid theirs
+    UInt32 used_identifiers = 0;
+    track new_tracks[CONTACT_TRACKER_MAX_CONTACTS];
+    UInt8 new_track_count = 0;
+
+    for (int i = 0; i < contact_count; i++) {
+        if (matches[i] == -1)
+            continue;
+
+        track& previous = tracks[matches[i]];
+        used_identifiers |= (1U << previous.identifier);
+
+        if (previous.device_identifier != contacts[i]->secondary_id)
+            identifier_changes++;
+    }
+
+    for (int i = 0; i < contact_count; i++) {
+        VoodooI2CDigitiserTransducer* transducer = contacts[i];
+        UInt8 identifier;
+
+        if (matches[i] != -1) {
+            identifier = tracks[matches[i]].identifier;
+        } else {
+            identifier = 0;
+            while (used_identifiers & (1U << identifier))
+                identifier++;
+
+            used_identifiers |= (1U << identifier);
+
+            new_contacts++;
+            if (unmatched_tracks && transducer->tip_switch.value())
+                gated_contacts++;
+        }
+
+        // A lifted contact keeps its identifier for this last report and is forgotten afterwards
+        if (transducer->tip_switch.value()) {
+            track& next = new_tracks[new_track_count++];
+            next.identifier = identifier;
+            next.device_identifier = transducer->secondary_id;
+            next.x = transducer->coordinates.x.value();
+            next.y = transducer->coordinates.y.value();
+        }
+
+        transducer->secondary_id = identifier;
+    }
+
+    memcpy(tracks, new_tracks, new_track_count * sizeof(track));
+    track_count = new_track_count;
+
+    return true;
+}
+
+void VoodooI2CHIDContactTracker::reset() {
+    track_count = 0;
+}
@@ -0,0 +1,66 @@
+//
+//  VoodooI2CHIDContactTracker.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDContactTracker_hpp
+#define VoodooI2CHIDContactTracker_hpp
+
+#include "VoodooI2CHIDInputPipeline.hpp"
+
+#include "../../../Multitouch Support/VoodooI2CDigitiserTransducer.hpp"
+
+#define CONTACT_TRACKER_MAX_CONTACTS 16
+
+/* Assigns stable identifiers to contacts for digitisers whose Contact Identifiers cannot be trusted
+ *
+ * Every contact of a frame is matched to the nearest contact of the previous frame, closest pairs first, as long as
+ * they are no further apart than the gating distance. Matched contacts inherit the identifier of their predecessor,
+ * the others are given the lowest free identifier. The work per frame is bounded by the cube of the maximum contact
+ * count, which is itself capped at <CONTACT_TRACKER_MAX_CONTACTS>.
+ */
+
+class VoodooI2CHIDContactTracker : public VoodooI2CHIDInputStage {
+ public:
+    bool enabled = false;
+
+    UInt32 new_contacts = 0;
+    UInt32 gated_contacts = 0;      // New contacts while a free track was beyond the gate
+    UInt32 identifier_changes = 0;
+
+    /* Adapts the tracker to the digitiser
+     * @maximum_contacts The maximum number of contacts the device reports in a frame
+     * @gate The maximum distance in logical units a contact may travel between two frames, 0 to derive it from the axes
+     */
+
+    void configure(UInt8 maximum_contacts, UInt32 gate);
+
+    const char* getStageName() const { return "Tracking"; }
+
+    bool processFrame(VoodooI2CHIDInputFrame& frame);
+
+    /* Forgets every contact */
+
+    void reset();
+
+ private:
+    struct track {
+        UInt8 identifier;
+        UInt32 device_identifier;
+        UInt32 x;
+        UInt32 y;
+    };
+
+    UInt8 maximum_contacts = CONTACT_TRACKER_MAX_CONTACTS;
+    UInt32 gate = 0;
+    uint64_t gate_squared = 0;
+
+    track tracks[CONTACT_TRACKER_MAX_CONTACTS] = {};
+    UInt8 track_count = 0;
+};
+
+
+#endif /* VoodooI2CHIDContactTracker_hpp */
@@ -0,0 +1,117 @@
+//
+//  VoodooI2CHIDCoordinateTransform.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDCoordinateTransform.hpp"
+
+void VoodooI2CHIDCoordinateTransform::apply(UInt32 x, UInt32 y, IOFixed* out_x, IOFixed* out_y) const {
+    UInt32 values[2] = {x, y};
+    UInt32 scaled[2];
+
+    for (int i = 0; i < 2; i++) {
+        const axis& current = axes[i];
+        UInt32 offset = 0;
+
+        if (values[i] > current.min)
+            offset = values[i] - current.min;
+
+        if (offset > current.range)
+            offset = current.range;
+
+        scaled[i] = static_cast<UInt32>((offset * current.multiplier) >> 32);
+    }
+
+    *out_x = invert[0] ? COORDINATE_TRANSFORM_MAX - scaled[source[0]] : scaled[source[0]];
+    *out_y = invert[1] ? COORDINATE_TRANSFORM_MAX - scaled[source[1]] : scaled[source[1]];
+}
+
+void VoodooI2CHIDCoordinateTransform::configure(UInt32 min_x, UInt32 max_x, UInt32 min_y, UInt32 max_y) {
+    UInt32 minimums[2] = {min_x, min_y};
+    UInt32 maximums[2] = {max_x, max_y};
+
+    for (int i = 0; i < 2; i++) {
+        axes[i].min = minimums[i];
+        axes[i].range = maximums[i] > minimums[i] ? maximums[i] - minimums[i] : 0;
+        axes[i].multiplier = multiplierForRange(axes[i].range);
+    }
+}
+
+bool VoodooI2CHIDCoordinateTransform::configure(IOHIDElement* collection) {
+    OSArray* elements = collection ? collection->getChildElements() : NULL;
+    UInt32 max_x = 0;
+    UInt32 max_y = 0;
+
+    for (int i = 0; elements && i < elements->getCount(); i++) {
+        IOHIDElement* element = OSDynamicCast(IOHIDElement, elements->getObject(i));
+
+        if (!element)
+            continue;
+
+        if (element->conformsTo(kHIDPage_GenericDesktop, kHIDUsage_GD_X))
+            max_x = element->getLogicalMax();
+        else if (element->conformsTo(kHIDPage_GenericDesktop, kHIDUsage_GD_Y))
+            max_y = element->getLogicalMax();
+    }
+
+    if (!max_x || !max_y)
+        return false;
+
+    configure(0, max_x, 0, max_y);
+
+    return true;
+}
+
+uint64_t VoodooI2CHIDCoordinateTransform::multiplierForRange(UInt32 range) {
+    if (!range)
+        return 0;
+
+    // Rounding up keeps the result exact for every offset within the range as long as the range is below 65536
+    return ((static_cast<uint64_t>(COORDINATE_TRANSFORM_MAX) << 32) + range - 1) / range;
+}
+
+IOFixed VoodooI2CHIDCoordinateTransform::scale(UInt32 value, UInt32 max) {
+    if (!max)
+        return 0;
+
+    return static_cast<IOFixed>((static_cast<uint64_t>(value) * COORDINATE_TRANSFORM_MAX) / max);
+}
+
+UInt32 VoodooI2CHIDCoordinateTransform::scalePhysicalMax(UInt32 physical_max, UInt32 unit_exponent, UInt32 unit) {
+    uint64_t scaled = physical_max;
+
+    SInt8 exponent = unit_exponent & 0x0F;
+    if (exponent & 0x08)
+        exponent -= 0x10;
+
+    // At most nine multiplications, which fits in 64 bits for any 32-bit maximum
+    for (int scale = exponent + 2; scale > 0; scale--)
+        scaled *= 10;
+
+    for (int scale = exponent + 2; scale < 0; scale++)
+        scaled /= 10;
+
+    // Saturate before the inch conversion can overflow
+    if (scaled > UINT32_MAX)
+        return UINT32_MAX;
+
+    // Inches
+    if (unit == 0x13)
+        scaled = (scaled * 254) / 100;
+
+    return scaled > UINT32_MAX ? UINT32_MAX : static_cast<UInt32>(scaled);
+}
+
+void VoodooI2CHIDCoordinateTransform::setRotation(UInt8 rotation) {
+    // Swapping happens before inverting, the inversions apply to the output axes
+    bool swap = rotation & kIOFBSwapAxes;
+
+    source[0] = swap ? 1 : 0;
+    source[1] = swap ? 0 : 1;
+
+    invert[0] = rotation & kIOFBInvertX;
+    invert[1] = rotation & kIOFBInvertY;
+}
@@ -0,0 +1,108 @@
+//
+//  VoodooI2CHIDCoordinateTransform.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDCoordinateTransform_hpp
+#define VoodooI2CHIDCoordinateTransform_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <IOKit/graphics/IOGraphicsTypes.h>
+#include <IOKit/hid/IOHIDElement.h>
+#include <IOKit/hid/IOHIDUsageTables.h>
+
+#define COORDINATE_TRANSFORM_MAX 65535
+
+/* Maps logical digitiser coordinates onto the 0 - 65535 range of the pointer events
+ *
+ * Each axis is scaled from its calibrated logical range with a 32.32 fixed point multiplier, which gives the same
+ * result as dividing by the size of the range for every range below 65536. The display rotation is folded in as a
+ * choice of source axis and an inversion per output axis so that a contact is mapped with two multiplications and no
+ * branching on the rotation. Everything is precomputed in <configure> and <setRotation>.
+ */
+
+class VoodooI2CHIDCoordinateTransform {
+ public:
+    /* Sets the logical range of either axis
+     * @min_x The logical value mapped to 0 on the X axis
+     * @max_x The logical value mapped to 65535 on the X axis
+     * @min_y The logical value mapped to 0 on the Y axis
+     * @max_y The logical value mapped to 65535 on the Y axis
+     *
+     * The logical minimum and maximum of the axes map the whole surface, a narrower range calibrates the digitiser
+     * against the panel it sits on.
+     */
+
+    void configure(UInt32 min_x, UInt32 max_x, UInt32 min_y, UInt32 max_y);
+
+    /* Sets the logical range of either axis from the X and Y elements of a transducer collection
+     * @collection The finger or stylus collection
+     *
+     * The range is known as soon as the report descriptor has been parsed, before any report has been decoded.
+     *
+     * @return *true* if the collection has both an X and a Y element, *false* otherwise
+     */
+
+    bool configure(IOHIDElement* collection);
+
+    /* Sets the rotation of the display
+     * @rotation A combination of <kIOFBSwapAxes>, <kIOFBInvertX> and <kIOFBInvertY>
+     */
+
+    void setRotation(UInt8 rotation);
+
+    /* Maps a logical coordinate
+     * @x The logical X coordinate
+     * @y The logical Y coordinate
+     * @out_x The mapped X coordinate
+     * @out_y The mapped Y coordinate
+     */
+
+    void apply(UInt32 x, UInt32 y, IOFixed* out_x, IOFixed* out_y) const;
+
+    /* Maps a logical value onto the 0 - 65535 range without a transform
+     * @value The logical value
+     * @max The logical maximum
+     *
+     * @return The mapped value
+     */
+
+    static IOFixed scale(UInt32 value, UInt32 max);
+
+    /* Converts the physical maximum of an axis to hundredths of a centimetre
+     * @physical_max The Physical Maximum of the axis element
+     * @unit_exponent The Unit Exponent of the axis element, a 4-bit two's complement integer
+     * @unit The Unit of the axis element
+     *
+     * @return The scaled physical maximum, saturated at UINT32_MAX
+     */
+
+    static UInt32 scalePhysicalMax(UInt32 physical_max, UInt32 unit_exponent, UInt32 unit);
+
+ private:
+    struct axis {
+        UInt32 min;
+        UInt32 range;
+        uint64_t multiplier;
+    };
+
+    axis axes[2] = {};
+
+    UInt8 source[2] = {0, 1};       // Indexed by the output axis
+    bool invert[2] = {};            // Indexed by the output axis
+
+    /* Computes the multiplier of an axis
+     * @range The size of the logical range of the axis
+     *
+     * @return The 32.32 fixed point multiplier
+     */
+
+    static uint64_t multiplierForRange(UInt32 range);
+};
+
+
+#endif /* VoodooI2CHIDCoordinateTransform_hpp */
@@ -20,6 +20,7 @@ bool VoodooI2CHIDDevice::init(OSDictionary* properties) {
         return false;
     awake = true;
     read_in_progress = false;
+    input_pending = false;
     bool temp = false;
     reset_event = &temp;
     sim_report_buffer = 0;
@@ -28,6 +29,18 @@ bool VoodooI2CHIDDevice::init(OSDictionary* properties) {
     i2chid_mdata = 0;
     i2chid_pattern = 0;
     memset(&hid_descriptor, 0, sizeof(VoodooI2CHIDDeviceHIDDescriptor));
+    memset(report_routes, 0, sizeof(report_routes));
+    memset(route_clients, 0, sizeof(route_clients));
+    uses_report_ids = false;
+    report_routes_ready = false;
+    zero_length_reads = 0;
+    oversized_reports = 0;
+    failed_reads = 0;
+    batched_reads = 0;
+    batched_reports = 0;
+    interrupt_count = 0;
+    reporting_suspended = false;
+    statistics_timestamp = 0;
     
     client_lock = IOLockAlloc();
     
@@ -163,7 +176,48 @@ void VoodooI2CHIDDevice::logHexDump(const void *data, int size) const {
 }
 
 bool VoodooI2CHIDDevice::getInputReport() {
+    bool result;
+    UInt32 batch_size = 0;
+
+    // Reports that came in while we were busy are read right away rather than after another interrupt and thread
+    do {
+        input_pending = false;
+        result = readInputReport();
+        batch_size++;
+    } while (!interrupt_simulator && awake && input_pending && batch_size < I2C_HID_MAX_INPUT_BATCH);
+
+    if (batch_size > 1) {
+        OSIncrementAtomic(&batched_reads);
+        OSAddAtomic(batch_size - 1, &batched_reports);
+    }
+
+    // The batch is full but a report is still waiting, hand it to a fresh thread rather than leaving it until the next
+    // interrupt. The read stays in progress and the pending flag stays set until that thread has read it.
+    if (!interrupt_simulator && input_pending) {
+        thread_t new_thread;
+
+        if (awake && kernel_thread_start(OSMemberFunctionCast(thread_continue_t, this, &VoodooI2CHIDDevice::getInputReport), this, &new_thread) == KERN_SUCCESS) {
+            thread_deallocate(new_thread);
+            thread_terminate(current_thread());
+            return result;
+        }
+
+        // Nobody is going to read it now, clients must not hold back their frames for it
+        input_pending = false;
+    }
+
+    read_in_progress = false;
+    command_gate->commandWakeup(&read_in_progress);
+
+    if (!interrupt_simulator)
+        thread_terminate(current_thread());
+
+    return result;
+}
+
+bool VoodooI2CHIDDevice::readInputReport() {
     IOBufferMemoryDescriptor* buffer;
+    VoodooI2CHIDDeviceReportRoute* route;
     IOReturn ret;
     
     uint8_t *report = interrupt_simulator ? sim_report_buffer : (uint8_t*)IOMalloc(hid_descriptor.wMaxInputLength);
@@ -172,9 +226,14 @@ bool VoodooI2CHIDDevice::getInputReport() {
 
     ret = api->readI2C(report, hid_descriptor.wMaxInputLength);
     
+    if (ret != kIOReturnSuccess)
+        OSIncrementAtomic(&failed_reads);
+
     int return_size = (ret == kIOReturnSuccess) ? (report[0] | report[1] << 8) : 0;
     if (!return_size) {
         // IOLog("%s::%s Device sent a 0-length report\n", getName(), name);
+        if (ret == kIOReturnSuccess)
+            OSIncrementAtomic(&zero_length_reads);
         command_gate->commandWakeup(&reset_event);
         goto exit;
     }
@@ -184,26 +243,42 @@ bool VoodooI2CHIDDevice::getInputReport() {
 
     if (return_size > hid_descriptor.wMaxInputLength) {
         // IOLog("%s: Incomplete report %d/%d\n", getName(), hid_descriptor.wMaxInputLength, return_size);
+        OSIncrementAtomic(&oversized_reports);
         goto exit;
     }
 
+    route = NULL;
+
+    if (report_routes_ready && return_size > 2) {
+        route = &report_routes[uses_report_ids ? report[2] : 0];
+
+        // Nobody can parse a report the descriptor does not declare, keep it away from the HID stack
+        if (!route->input) {
+            OSIncrementAtomic(&route->dropped);
+            goto exit;
+        }
+
+        OSIncrementAtomic(&route->reports);
+        OSAddAtomic64(return_size - 2, &route->bytes);
+    }
+
     buffer = IOBufferMemoryDescriptor::inTaskWithOptions(kernel_task, 0, return_size);
     buffer->writeBytes(0, report + 2, return_size - 2);
     
     ret = handleReport(buffer, kIOHIDReportTypeInput);
 
-    if (ret != kIOReturnSuccess)
+    if (ret != kIOReturnSuccess) {
+        if (route)
+            OSIncrementAtomic(&route->failed);
         IOLog("%s::%s Error handling input report: 0x%.8x\n", getName(), name, ret);
+    }
     
     buffer->release();
-    if (!interrupt_simulator)
-        IOFree(report, hid_descriptor.wMaxInputLength);
     
 exit:
-    read_in_progress = false;
     if (!interrupt_simulator)
-        thread_terminate(current_thread());
-  
+        IOFree(report, hid_descriptor.wMaxInputLength);
+
     if (interrupt_simulator && return_size > 0 && return_size <= hid_descriptor.wMaxInputLength && ret == kIOReturnSuccess) {
         if (i2chid_dbg)
             logHexDump(report, return_size);
@@ -272,8 +347,12 @@ IOReturn VoodooI2CHIDDevice::getReport(IOMemoryDescriptor* report, IOHIDReportTy
 }
 
 bool VoodooI2CHIDDevice::interruptOccured(OSObject* owner, IOInterruptEventSource* src, int intCount) {
-    if (read_in_progress)
+    OSIncrementAtomic(&interrupt_count);
+
+    if (read_in_progress) {
+        input_pending = true;
         return false;
+    }
     if (!awake)
         return false;
     
@@ -534,6 +613,10 @@ IOReturn VoodooI2CHIDDevice::setPowerState(unsigned long whichState, IOService*
             api->writeI2C(command.data, 4);
             IOSleep(100);
 
+            // Waking up powered the device on, a client that disabled its digitiser still needs it in HID sleep
+            if (reporting_suspended && setHIDPowerState(kVoodooI2CStateOff) != kIOReturnSuccess)
+                reporting_suspended = false;
+
             read_in_progress = false;
             
             IOLog("%s::%s Woke up\n", getName(), name);
@@ -652,6 +735,15 @@ bool VoodooI2CHIDDevice::start(IOService* provider) {
         }
     }
     
+    // The report descriptor has been parsed by now, map each input report ID to its application collection
+    OSArray* elements = OSDynamicCast(OSArray, getProperty(kIOHIDElementKey));
+
+    if (elements) {
+        buildReportRoutes(elements, 0, 0);
+        report_routes_ready = true;
+        publishReportRoutes();
+    }
+
     ready_for_input = true;
     
     setProperty("VoodooI2CServices Supported", kOSBooleanTrue);
@@ -765,3 +857,271 @@ void VoodooI2CHIDDevice::close(IOService *forClient, IOOptionBits options) {
     
     super::close(forClient, options);
 }
+
+IOReturn VoodooI2CHIDDevice::addReportRoute(IOService* client, UInt8 report_id) {
+    int slot = -1;
+
+    IOLockLock(client_lock);
+
+    for (int i = 0; i < I2C_HID_MAX_ROUTE_CLIENTS; i++) {
+        if (route_clients[i] == client) {
+            slot = i;
+            break;
+        }
+
+        if (slot == -1 && !route_clients[i])
+            slot = i;
+    }
+
+    if (slot == -1) {
+        IOLockUnlock(client_lock);
+        IOLog("%s::%s Too many report route clients\n", getName(), name);
+        return kIOReturnNoResources;
+    }
+
+    route_clients[slot] = client;
+    report_routes[report_id].clients |= (1U << slot);
+
+    IOLockUnlock(client_lock);
+
+    return kIOReturnSuccess;
+}
+
+void VoodooI2CHIDDevice::buildReportRoutes(OSArray* elements, UInt32 usage_page, UInt32 usage) {
+    for (int i = 0; i < elements->getCount(); i++) {
+        IOHIDElement* element = OSDynamicCast(IOHIDElement, elements->getObject(i));
+
+        if (!element)
+            continue;
+
+        IOHIDElementType type = element->getType();
+
+        if (type == kIOHIDElementTypeCollection) {
+            OSArray* children = element->getChildElements();
+
+            if (!children)
+                continue;
+
+            if (element->getCollectionType() == kIOHIDElementCollectionTypeApplication)
+                buildReportRoutes(children, element->getUsagePage(), element->getUsage());
+            else
+                buildReportRoutes(children, usage_page, usage);
+
+            continue;
+        }
+
+        if (type < kIOHIDElementTypeInput_Misc || type > kIOHIDElementTypeInput_ScanCodes)
+            continue;
+
+        UInt8 report_id = element->getReportID() & 0xFF;
+
+        if (report_id)
+            uses_report_ids = true;
+
+        VoodooI2CHIDDeviceReportRoute* route = &report_routes[report_id];
+
+        if (!route->input) {
+            route->input = true;
+            route->usage_page = usage_page;
+            route->usage = usage;
+        }
+    }
+}
+
+bool VoodooI2CHIDDevice::isReportRouted(IOService* client, UInt8 report_id) {
+    bool routed = true;
+
+    // Routes are registered and removed by other threads while reports are being dispatched
+    IOLockLock(client_lock);
+
+    for (int i = 0; i < I2C_HID_MAX_ROUTE_CLIENTS; i++) {
+        if (route_clients[i] == client) {
+            routed = report_routes[report_id].clients & (1U << i);
+            break;
+        }
+    }
+
+    IOLockUnlock(client_lock);
+
+    return routed;
+}
+
+void VoodooI2CHIDDevice::publishReportRoutes() {
+    OSDictionary* routes = OSDictionary::withCapacity(4);
+
+    if (!routes)
+        return;
+
+    uint64_t now_abs;
+    clock_get_uptime(&now_abs);
+
+    uint64_t interval_ms = 0;
+
+    if (statistics_timestamp) {
+        uint64_t interval_ns;
+        absolutetime_to_nanoseconds(now_abs - statistics_timestamp, &interval_ns);
+        interval_ms = interval_ns / 1000000;
+    }
+
+    statistics_timestamp = now_abs;
+
+    for (int i = 0; i < I2C_HID_REPORT_ID_COUNT; i++) {
+        VoodooI2CHIDDeviceReportRoute* route = &report_routes[i];
+
+        if (!route->input && !route->dropped)
+            continue;
+
+        OSDictionary* properties = OSDictionary::withCapacity(8);
+
+        if (!properties)
+            continue;
+
+        UInt32 client_count = 0;
+
+        for (UInt32 clients = route->clients; clients; clients &= clients - 1)
+            client_count++;
+
+        // Reports per second since the statistics were last published
+        UInt32 reports = route->reports;
+        UInt32 rate = interval_ms ? static_cast<UInt32>(((reports - route->published_reports) * 1000ULL) / interval_ms) : 0;
+        route->published_reports = reports;
+
+        OSNumber* number = OSNumber::withNumber(route->usage_page, 32);
+        properties->setObject("UsagePage", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(route->usage, 32);
+        properties->setObject("Usage", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(client_count, 32);
+        properties->setObject("Clients", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(reports, 32);
+        properties->setObject("Reports", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(rate, 32);
+        properties->setObject("ReportsPerSecond", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(route->bytes, 64);
+        properties->setObject("Bytes", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(route->dropped, 32);
+        properties->setObject("Dropped", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(route->failed, 32);
+        properties->setObject("Failed", number);
+        OSSafeReleaseNULL(number);
+
+        char key[4];
+        snprintf(key, sizeof(key), "%d", i);
+        routes->setObject(key, properties);
+        properties->release();
+    }
+
+    setProperty("ReportRoutes", routes);
+    routes->release();
+
+    OSDictionary* statistics = OSDictionary::withCapacity(5);
+
+    if (!statistics)
+        return;
+
+    OSNumber* number = OSNumber::withNumber(zero_length_reads, 32);
+    statistics->setObject("ZeroLengthReads", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(oversized_reports, 32);
+    statistics->setObject("OversizedReports", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(failed_reads, 32);
+    statistics->setObject("FailedReads", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(batched_reads, 32);
+    statistics->setObject("BatchedReads", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(batched_reports, 32);
+    statistics->setObject("BatchedReports", number);
+    OSSafeReleaseNULL(number);
+
+    setProperty("ReportStatistics", statistics);
+    statistics->release();
+}
+
+void VoodooI2CHIDDevice::removeReportRoutes(IOService* client) {
+    IOLockLock(client_lock);
+
+    for (int i = 0; i < I2C_HID_MAX_ROUTE_CLIENTS; i++) {
+        if (route_clients[i] != client)
+            continue;
+
+        for (int j = 0; j < I2C_HID_REPORT_ID_COUNT; j++)
+            report_routes[j].clients &= ~(1U << i);
+
+        route_clients[i] = NULL;
+        break;
+    }
+
+    IOLockUnlock(client_lock);
+}
+
+IOReturn VoodooI2CHIDDevice::setReportingSuspended(bool suspended) {
+    return command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CHIDDevice::setReportingSuspendedGated), &suspended);
+}
+
+IOReturn VoodooI2CHIDDevice::setReportingSuspendedGated(bool* suspended) {
+    if (*suspended == reporting_suspended)
+        return kIOReturnSuccess;
+
+    // Only put the whole device to sleep if nothing but the digitiser and its mouse fallback would go quiet
+    for (int i = 0; i < I2C_HID_REPORT_ID_COUNT; i++) {
+        VoodooI2CHIDDeviceReportRoute* route = &report_routes[i];
+
+        if (!route->input || route->usage_page == kHIDPage_Digitizer)
+            continue;
+
+        if (route->usage_page != kHIDPage_GenericDesktop || (route->usage != kHIDUsage_GD_Mouse && route->usage != kHIDUsage_GD_Pointer))
+            return kIOReturnNotPermitted;
+    }
+
+    // A sleeping device is powered off anyway, waking up applies the request
+    if (!awake) {
+        reporting_suspended = *suspended;
+        return kIOReturnSuccess;
+    }
+
+    // The read thread may need the gate to deliver its report, wait for it without holding the gate
+    while (read_in_progress) {
+        AbsoluteTime deadline;
+
+        clock_interval_to_deadline(10, kMillisecondScale, &deadline);
+        command_gate->commandSleep(&read_in_progress, deadline, THREAD_UNINT);
+    }
+
+    IOReturn ret = setHIDPowerState(*suspended ? kVoodooI2CStateOff : kVoodooI2CStateOn);
+
+    if (ret == kIOReturnSuccess)
+        reporting_suspended = *suspended;
+
+    IOLog("%s::%s %s reporting: 0x%.8x\n", getName(), name, *suspended ? "Suspended" : "Resumed", ret);
+
+    return ret;
+}
+
+IOReturn VoodooI2CHIDDevice::setProperties(OSObject* properties) {
+    OSDictionary* dict = OSDynamicCast(OSDictionary, properties);
+
+    // Statistics are only published when asked for so that the read path never has to touch the registry
+    if (dict && dict->getObject("UpdateReportStatistics"))
+        publishReportRoutes();
+
+    return super::setProperties(properties);
+}
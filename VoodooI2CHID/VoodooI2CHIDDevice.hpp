@@ -26,6 +26,10 @@
 #define I2C_HID_PWR_ON  0x00
 #define I2C_HID_PWR_SLEEP 0x01
 
+#define I2C_HID_REPORT_ID_COUNT   256
+#define I2C_HID_MAX_ROUTE_CLIENTS 32
+#define I2C_HID_MAX_INPUT_BATCH   8
+
 #define EXPORT __attribute__((visibility("default")))
 
 typedef union {
@@ -54,6 +58,21 @@ typedef struct __attribute__((__packed__)) {
     UInt32 reserved;
 } VoodooI2CHIDDeviceHIDDescriptor;
 
+typedef struct {
+    bool input;             // The report descriptor declares input items with this report ID
+    UInt32 usage_page;      // Usage page of the application collection the report belongs to
+    UInt32 usage;           // Usage of the application collection the report belongs to
+    UInt32 clients;         // Bitmask of the route clients interested in this report ID
+
+    // Traffic counters, updated atomically from the read path
+    SInt32 reports;
+    SInt32 dropped;
+    SInt32 failed;          // Reports rejected by <IOHIDDevice::handleReport>
+    SInt64 bytes;
+
+    UInt32 published_reports;   // Value of <reports> when the statistics were last published
+} VoodooI2CHIDDeviceReportRoute;
+
 class VoodooI2CDeviceNub;
 
 /* Implements an I2C-HID device as specified by Microsoft's protocol in the following document: http://download.microsoft.com/download/7/D/D/7DD44BB7-2A7A-4505-AC1C-7227D3D96D5B/hid-over-i2c-protocol-spec-v1-0.docx
@@ -194,14 +213,92 @@ class EXPORT VoodooI2CHIDDevice : public IOHIDDevice {
     bool open(IOService *forClient, IOOptionBits options = 0, void *arg = 0) override;
     void close(IOService *forClient, IOOptionBits options) override;
 
+    /* Registers a client's interest in the input reports carrying a given report ID
+     * @client The client, usually an HID event driver, that handles the report
+     * @report_id The report ID the client is interested in
+     *
+     * @return *kIOReturnSuccess* on success, *kIOReturnNoResources* if the maximum number of route clients has been reached
+     */
+
+    IOReturn addReportRoute(IOService* client, UInt8 report_id);
+
+    /* Returns the number of interrupts the device has raised since it was started
+     */
+
+    UInt32 getInterruptCount() const { return interrupt_count; }
+
+    /* Checks whether the device raised an interrupt while the current input report was being handled
+     *
+     * Clients may use this to tell that the report they are handling is already outdated.
+     *
+     * @return *true* if another input report is about to be read, *false* otherwise
+     */
+
+    bool isInputPending() const { return input_pending; }
+
+    /* Checks whether an input report is routed to a given client
+     * @client The client to check for
+     * @report_id The report ID of the input report
+     *
+     * Clients which have not registered any routes receive every report.
+     *
+     * @return *true* if the client should handle the report, *false* otherwise
+     */
+
+    bool isReportRouted(IOService* client, UInt8 report_id);
+
+    /* Removes all report routes registered by a client
+     * @client The client whose routes are to be removed
+     */
+
+    void removeReportRoutes(IOService* client);
+
+    /* Puts the device into HID sleep to stop it from scanning and interrupting, or wakes it back up
+     * @suspended *true* to stop reporting, *false* to resume
+     *
+     * This is only allowed when every input report of the device belongs to a digitiser or pointer collection, a device
+     * that also carries a keyboard or other controls must keep reporting. The device is put back into HID sleep when the
+     * system wakes up until reporting is resumed.
+     *
+     * @return *kIOReturnSuccess* on success, *kIOReturnNotPermitted* if the device carries other collections
+     */
+
+    IOReturn setReportingSuspended(bool suspended);
+
+    /* Used to request a snapshot of the report statistics from user mode
+     * @properties OSDictionary of configured properties
+     *
+     * Setting *UpdateReportStatistics* publishes the current per-report-ID counters and rates to the IOService plane,
+     * every property is then passed on to <IOHIDDevice::setProperties>.
+     *
+     * @return The result of <IOHIDDevice::setProperties>
+     */
+
+    IOReturn setProperties(OSObject* properties) override;
+
  protected:
     bool awake;
     bool read_in_progress;
+    volatile bool input_pending;
     IOWorkLoop* work_loop;
     
     IOLock* client_lock;
     OSArray* clients;
 
+    VoodooI2CHIDDeviceReportRoute report_routes[I2C_HID_REPORT_ID_COUNT];
+    IOService* route_clients[I2C_HID_MAX_ROUTE_CLIENTS];
+    bool uses_report_ids;
+    bool report_routes_ready;
+
+    SInt32 zero_length_reads;
+    SInt32 oversized_reports;
+    SInt32 failed_reads;
+    SInt32 batched_reads;
+    SInt32 batched_reports;
+    SInt32 interrupt_count;
+    bool reporting_suspended;
+    uint64_t statistics_timestamp;
+
     VoodooI2CHIDDeviceHIDDescriptor hid_descriptor;
 
     IOReturn resetHIDDeviceGated();
@@ -257,15 +354,50 @@ class EXPORT VoodooI2CHIDDevice : public IOHIDDevice {
     int  i2chid_mdata;
     OSData *i2chid_pattern;
 
-    /* Queries the I2C-HID device for an input report
+    /* Queries the I2C-HID device for input reports
      *
      * This function is called from the interrupt handler in a new thread. It is thus not called from interrupt context.
+     * Interrupts raised while a report is being read are not lost, the reports behind them are read in the same thread
+     * once the current one has been handled, up to <I2C_HID_MAX_INPUT_BATCH> reports in a row. A backlog that is still
+     * pending after that is handed over to a new thread.
      */
 
     bool getInputReport();
 
+    /* Builds the report routing table from the parsed report descriptor
+     * @elements The HID elements to walk
+     * @usage_page The usage page of the enclosing application collection
+     * @usage The usage of the enclosing application collection
+     *
+     * This function is called recursively for every collection found in <elements>.
+     */
+
+    void buildReportRoutes(OSArray* elements, UInt32 usage_page, UInt32 usage);
+
+    /* Publishes the report routing table and its traffic counters to the IOService plane
+     *
+     * This is only done on request as rates are computed over the interval since the previous call.
+     */
+
+    void publishReportRoutes();
+
+    /* Gated half of <setReportingSuspended>
+     * @suspended Pointer to a boolean, *true* to stop reporting and *false* to resume
+     */
+
+    IOReturn setReportingSuspendedGated(bool* suspended);
+
+    /* Reads a single input report from the I2C-HID device and hands it to the HID stack
+     *
+     * @return *true* if the interrupt simulator should keep polling at the busy rate, *false* otherwise
+     */
+
+    bool readInputReport();
+
     /*
     * This function is called when the I2C-HID device asserts its interrupt line.
+    *
+    * If a report is being read at the time, the interrupt is remembered for <getInputReport> to pick up.
     */
     
     bool interruptOccured(OSObject* owner, IOInterruptEventSource* src, int intCount);
@@ -0,0 +1,114 @@
+//
+//  VoodooI2CHIDDisplayBinding.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDDisplayBinding.hpp"
+
+void VoodooI2CHIDDisplayBinding::configure(OSDictionary* binding) {
+    if (!binding)
+        return;
+
+    OSNumber* vendor = OSDynamicCast(OSNumber, binding->getObject(kDisplayVendorID));
+    OSNumber* product = OSDynamicCast(OSNumber, binding->getObject(kDisplayProductID));
+    OSBoolean* built_in = OSDynamicCast(OSBoolean, binding->getObject(kDisplayBindingBuiltInKey));
+
+    if (vendor) {
+        match_vendor = true;
+        vendor_id = vendor->unsigned32BitValue();
+    }
+
+    if (product) {
+        match_product = true;
+        product_id = product->unsigned32BitValue();
+    }
+
+    if (built_in)
+        prefer_built_in = built_in->isTrue();
+}
+
+IOFramebuffer* VoodooI2CHIDDisplayBinding::framebufferForDisplay(IOService* display) {
+    IORegistryEntry* entry = display->getParentEntry(gIOServicePlane);
+
+    if (entry)
+        entry = entry->getParentEntry(gIOServicePlane);
+
+    return entry ? OSDynamicCast(IOFramebuffer, entry) : NULL;
+}
+
+bool VoodooI2CHIDDisplayBinding::offer(IOService* display) {
+    UInt8 display_rating = rate(display);
+
+    // The first display published wins ties so that the binding does not move between equal displays
+    if (display_rating <= rating)
+        return false;
+
+    IOFramebuffer* display_framebuffer = framebufferForDisplay(display);
+
+    display_framebuffer->retain();
+    OSSafeReleaseNULL(framebuffer);
+
+    framebuffer = display_framebuffer;
+    this->display = display;
+    rating = display_rating;
+
+    return true;
+}
+
+UInt8 VoodooI2CHIDDisplayBinding::rate(IOService* display) const {
+    if (!display || display->isInactive() || !framebufferForDisplay(display))
+        return 0;
+
+    if (match_vendor || match_product) {
+        OSNumber* vendor = OSDynamicCast(OSNumber, display->getProperty(kDisplayVendorID));
+        OSNumber* product = OSDynamicCast(OSNumber, display->getProperty(kDisplayProductID));
+
+        if ((!match_vendor || (vendor && vendor->unsigned32BitValue() == vendor_id)) &&
+            (!match_product || (product && product->unsigned32BitValue() == product_id)))
+            return 3;
+    }
+
+    // Built-in panels are driven by AppleBacklightDisplay, external displays by AppleDisplay
+    if (prefer_built_in && display->metaCast("AppleBacklightDisplay"))
+        return 2;
+
+    return 1;
+}
+
+bool VoodooI2CHIDDisplayBinding::release(IOService* display) {
+    if (!display || display != this->display)
+        return false;
+
+    reset();
+
+    return true;
+}
+
+bool VoodooI2CHIDDisplayBinding::rescan() {
+    bool moved = false;
+
+    OSDictionary* matching = IOService::serviceMatching("IODisplay");
+    OSIterator* iterator = matching ? IOService::getMatchingServices(matching) : NULL;
+
+    if (iterator) {
+        IOService* candidate;
+
+        while ((candidate = OSDynamicCast(IOService, iterator->getNextObject())))
+            moved |= offer(candidate);
+
+        iterator->release();
+    }
+
+    OSSafeReleaseNULL(matching);
+
+    return moved;
+}
+
+void VoodooI2CHIDDisplayBinding::reset() {
+    OSSafeReleaseNULL(framebuffer);
+    display = NULL;
+    rating = 0;
+}
@@ -0,0 +1,96 @@
+//
+//  VoodooI2CHIDDisplayBinding.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDDisplayBinding_hpp
+#define VoodooI2CHIDDisplayBinding_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOService.h>
+#include <IOKit/graphics/IODisplay.h>
+#include <IOKit/graphics/IOFramebuffer.h>
+#include <IOKit/graphics/IOGraphicsTypes.h>
+
+#define kDisplayBindingKey "DisplayBinding"
+#define kDisplayBindingBuiltInKey "BuiltIn"
+
+/* Decides which display a touchscreen or orientation sensor belongs to
+ *
+ * Displays are offered to the binding as they are published. The binding is configured through a dictionary, usually
+ * the *DisplayBinding* property of the personality, which may name the panel by its *DisplayVendorID* and
+ * *DisplayProductID* and may set *BuiltIn* to *false* to stop preferring the built-in panel. A display that matches the
+ * vendor and product beats the built-in panel, which in turn beats any other display. When no display matches, the
+ * first one published is used as before so that machines with a single display need no configuration.
+ */
+
+class VoodooI2CHIDDisplayBinding {
+ public:
+    /* Reads the binding criteria
+     * @binding The configuration dictionary, may be *NULL*
+     */
+
+    void configure(OSDictionary* binding);
+
+    /* Considers a newly published display
+     * @display The display
+     *
+     * @return *true* if the binding moved to the display, *false* otherwise
+     */
+
+    bool offer(IOService* display);
+
+    /* Considers every display that is currently published
+     *
+     * @return *true* if the binding moved to another display, *false* otherwise
+     */
+
+    bool rescan();
+
+    /* Drops the binding if it is to a display that is going away
+     * @display The display being terminated
+     *
+     * @return *true* if the binding was dropped, *false* otherwise
+     */
+
+    bool release(IOService* display);
+
+    /* Drops the binding */
+
+    void reset();
+
+    IOFramebuffer* getFramebuffer() const { return framebuffer; }
+
+ private:
+    bool prefer_built_in = true;
+    bool match_vendor = false;
+    bool match_product = false;
+    UInt32 vendor_id = 0;
+    UInt32 product_id = 0;
+
+    IOService* display = NULL;
+    IOFramebuffer* framebuffer = NULL;
+    UInt8 rating = 0;
+
+    /* Finds the framebuffer driving a display
+     * @display The display
+     *
+     * @return The framebuffer, *NULL* if there is none
+     */
+
+    static IOFramebuffer* framebufferForDisplay(IOService* display);
+
+    /* Rates how well a display matches the binding criteria
+     * @display The display
+     *
+     * @return 0 if the display cannot be used, higher values for better matches
+     */
+
+    UInt8 rate(IOService* display) const;
+};
+
+
+#endif /* VoodooI2CHIDDisplayBinding_hpp */
@@ -0,0 +1,86 @@
+//
+//  VoodooI2CHIDDuplicateFrameFilter.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDDuplicateFrameFilter.hpp"
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME        0x100000001b3ULL
+
+static inline uint64_t hashValue(uint64_t hash, UInt32 value) {
+    for (int i = 0; i < 4; i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t VoodooI2CHIDDuplicateFrameFilter::fingerprint(VoodooI2CMultitouchEvent& event) {
+    uint64_t hash = hashValue(FNV_OFFSET_BASIS, event.contact_count);
+
+    if (!event.transducers)
+        return hash;
+
+    for (int i = 0; i < event.transducers->getCount(); i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(i));
+
+        if (!transducer)
+            continue;
+
+        UInt32 flags = (transducer->in_range ? 1 : 0) | (transducer->is_valid ? 2 : 0);
+
+        hash = hashValue(hash, transducer->type);
+        hash = hashValue(hash, transducer->secondary_id);
+        hash = hashValue(hash, flags);
+        hash = hashValue(hash, transducer->tip_switch.value());
+        hash = hashValue(hash, transducer->physical_button.value());
+        hash = hashValue(hash, transducer->tip_pressure.value() >> quantization_shift);
+        hash = hashValue(hash, transducer->coordinates.x.value() >> quantization_shift);
+        hash = hashValue(hash, transducer->coordinates.y.value() >> quantization_shift);
+
+        if (transducer->type == kDigitiserTransducerStylus) {
+            VoodooI2CDigitiserStylus* stylus = (VoodooI2CDigitiserStylus*)transducer;
+
+            hash = hashValue(hash, stylus->barrel_switch.value());
+            hash = hashValue(hash, stylus->eraser.value());
+            hash = hashValue(hash, stylus->invert ? 1 : 0);
+        }
+    }
+
+    return hash;
+}
+
+void VoodooI2CHIDDuplicateFrameFilter::reset() {
+    has_last_frame = false;
+    last_fingerprint = 0;
+    last_forwarded = 0;
+}
+
+bool VoodooI2CHIDDuplicateFrameFilter::shouldForward(VoodooI2CMultitouchEvent& event, AbsoluteTime timestamp) {
+    if (!enabled)
+        return true;
+
+    uint64_t now = timestamp;
+    uint64_t hash = fingerprint(event);
+
+    if (has_last_frame && hash == last_fingerprint && now >= last_forwarded) {
+        uint64_t elapsed_ns;
+        absolutetime_to_nanoseconds(now - last_forwarded, &elapsed_ns);
+
+        if (elapsed_ns < keep_alive_ms * 1000000ULL) {
+            suppressed_frames++;
+            return false;
+        }
+    }
+
+    has_last_frame = true;
+    last_fingerprint = hash;
+    last_forwarded = now;
+
+    return true;
+}
@@ -0,0 +1,66 @@
+//
+//  VoodooI2CHIDDuplicateFrameFilter.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDDuplicateFrameFilter_hpp
+#define VoodooI2CHIDDuplicateFrameFilter_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <kern/clock.h>
+
+#include "../../../Multitouch Support/VoodooI2CDigitiserStylus.hpp"
+#include "../../../Multitouch Support/MultitouchHelpers.hpp"
+
+#define DUPLICATE_FRAME_FILTER_DEFAULT_QUANTIZATION_SHIFT 2
+#define DUPLICATE_FRAME_FILTER_DEFAULT_KEEP_ALIVE_MS      50
+
+/* Drops frames whose decoded contact set is identical to the last delivered frame
+ *
+ * Many digitisers keep sending the same frame while a finger rests on the surface. The filter fingerprints the contact
+ * set of every frame (identifiers, tip and button states, pressure and coordinates quantized by <quantization_shift> bits)
+ * and reports whether it is worth forwarding. An unchanged frame is still delivered once <keep_alive_ms> have passed
+ * since the last delivered frame so that time-based gestures in the multitouch engines keep running.
+ */
+
+class VoodooI2CHIDDuplicateFrameFilter {
+ public:
+    bool enabled = false;
+    UInt8 quantization_shift = DUPLICATE_FRAME_FILTER_DEFAULT_QUANTIZATION_SHIFT;
+    UInt32 keep_alive_ms = DUPLICATE_FRAME_FILTER_DEFAULT_KEEP_ALIVE_MS;
+
+    UInt32 suppressed_frames = 0;
+
+    /* Decides whether a frame should be forwarded to the multitouch interface
+     * @event The frame about to be forwarded
+     * @timestamp The timestamp of the frame
+     *
+     * @return *true* if the frame differs from the last delivered frame or is needed for timing, *false* if it can be dropped
+     */
+
+    bool shouldForward(VoodooI2CMultitouchEvent& event, AbsoluteTime timestamp);
+
+    /* Forgets the last delivered frame so that the next frame is always forwarded */
+
+    void reset();
+
+ private:
+    bool has_last_frame = false;
+    uint64_t last_fingerprint = 0;
+    uint64_t last_forwarded = 0;
+
+    /* Computes the fingerprint of a frame
+     * @event The frame to fingerprint
+     *
+     * @return A 64-bit FNV-1a hash of the contact set
+     */
+
+    uint64_t fingerprint(VoodooI2CMultitouchEvent& event);
+};
+
+
+#endif /* VoodooI2CHIDDuplicateFrameFilter_hpp */
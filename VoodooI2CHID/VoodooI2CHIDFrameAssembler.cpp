@@ -0,0 +1,98 @@
+//
+//  VoodooI2CHIDFrameAssembler.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDFrameAssembler.hpp"
+
+void VoodooI2CHIDFrameAssembler::configure(UInt8 contacts_per_report, UInt8 maximum_contacts, bool has_identifiers) {
+    this->contacts_per_report = contacts_per_report ? contacts_per_report : 1;
+    this->maximum_contacts = maximum_contacts ? maximum_contacts : this->contacts_per_report;
+    this->has_identifiers = has_identifiers;
+
+    hybrid = this->maximum_contacts > this->contacts_per_report;
+
+    finishFrame();
+}
+
+void VoodooI2CHIDFrameAssembler::beginFrame(AbsoluteTime timestamp, UInt8 contact_count) {
+    uint64_t frame_start = timestamp;
+
+    if (last_frame_start && frame_start > last_frame_start) {
+        uint64_t interval_ns;
+        absolutetime_to_nanoseconds(frame_start - last_frame_start, &interval_ns);
+
+        // Gaps between touches say nothing about the scan rate
+        if (interval_ns < FRAME_ASSEMBLER_IDLE_GAP_US * 1000ULL)
+            cadence_ns = (cadence_ns * 7 + interval_ns) / 8;
+    }
+
+    last_frame_start = frame_start;
+
+    in_progress = true;
+    complete = false;
+    expected_contacts = contact_count > maximum_contacts ? maximum_contacts : contact_count;
+    received_contacts = 0;
+    report_contacts = 0;
+    current_report = 0;
+    contact_mask = 0;
+}
+
+void VoodooI2CHIDFrameAssembler::addContact(UInt32 contact_identifier) {
+    if (!in_progress || report_contacts >= contacts_per_report)
+        return;
+
+    report_contacts++;
+
+    if (received_contacts >= expected_contacts)
+        return;
+
+    if (has_identifiers) {
+        UInt32 bit = 1U << (contact_identifier & 0x1F);
+
+        // A contact we already have means the device repeated a report
+        if (contact_mask & bit)
+            return;
+
+        contact_mask |= bit;
+    }
+
+    received_contacts++;
+}
+
+void VoodooI2CHIDFrameAssembler::endReport() {
+    if (!in_progress)
+        return;
+
+    // Outside of hybrid mode every report carries the whole frame
+    if (!hybrid || received_contacts >= expected_contacts)
+        complete = true;
+
+    report_contacts = 0;
+    current_report++;
+}
+
+void VoodooI2CHIDFrameAssembler::finishFrame() {
+    in_progress = false;
+    complete = false;
+    expected_contacts = 0;
+    received_contacts = 0;
+    report_contacts = 0;
+    current_report = 0;
+    contact_mask = 0;
+}
+
+UInt32 VoodooI2CHIDFrameAssembler::getTimeoutUS() const {
+    // Allow one and a half frame periods for the rest of the frame to show up
+    uint64_t timeout_us = (cadence_ns * 3) / 2000;
+
+    if (timeout_us < FRAME_ASSEMBLER_MIN_TIMEOUT_US)
+        timeout_us = FRAME_ASSEMBLER_MIN_TIMEOUT_US;
+    if (timeout_us > FRAME_ASSEMBLER_MAX_TIMEOUT_US)
+        timeout_us = FRAME_ASSEMBLER_MAX_TIMEOUT_US;
+
+    return static_cast<UInt32>(timeout_us);
+}
@@ -0,0 +1,99 @@
+//
+//  VoodooI2CHIDFrameAssembler.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDFrameAssembler_hpp
+#define VoodooI2CHIDFrameAssembler_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <kern/clock.h>
+
+#define FRAME_ASSEMBLER_DEFAULT_CADENCE_US 8000
+#define FRAME_ASSEMBLER_MIN_TIMEOUT_US     4000
+#define FRAME_ASSEMBLER_MAX_TIMEOUT_US     40000
+#define FRAME_ASSEMBLER_IDLE_GAP_US        100000
+
+/* Assembles digitiser frames out of one or more input reports
+ *
+ * A device in hybrid reporting mode only sends the contact count in the first report of a frame, the remaining
+ * contacts follow in subsequent reports. The assembler accumulates the contacts of the current frame by their Contact
+ * Identifier and tells the event driver when the frame is complete. A frame whose remaining reports never arrive is
+ * flushed by the event driver once <getTimeoutUS> has elapsed, the timeout being derived from the observed frame cadence.
+ */
+
+class VoodooI2CHIDFrameAssembler {
+ public:
+    UInt32 incomplete_frames = 0;
+    UInt32 recovered_frames = 0;
+    UInt32 orphaned_reports = 0;
+
+    /* Adapts the assembler to the layout of the digitiser
+     * @contacts_per_report The number of finger collections in a single input report
+     * @maximum_contacts The maximum number of contacts the device reports in a frame
+     * @has_identifiers *true* if the finger collections carry a Contact Identifier
+     */
+
+    void configure(UInt8 contacts_per_report, UInt8 maximum_contacts, bool has_identifiers);
+
+    /* Starts a new frame
+     * @timestamp The timestamp of the first report of the frame
+     * @contact_count The number of contacts the frame is expected to contain
+     */
+
+    void beginFrame(AbsoluteTime timestamp, UInt8 contact_count);
+
+    /* Records a contact decoded from the current report
+     * @contact_identifier The Contact Identifier of the contact
+     */
+
+    void addContact(UInt32 contact_identifier);
+
+    /* Marks the end of the current report */
+
+    void endReport();
+
+    /* Resets the assembler once the current frame has been delivered */
+
+    void finishFrame();
+
+    UInt8 getContactCount() const { return expected_contacts; }
+    UInt8 getCurrentReport() const { return current_report; }
+    UInt8 getMaximumContacts() const { return maximum_contacts; }
+    UInt8 getReceivedContactCount() const { return received_contacts; }
+
+    /* Computes how long the event driver should wait for the remaining reports of a frame
+     *
+     * @return The timeout in microseconds
+     */
+
+    UInt32 getTimeoutUS() const;
+
+    bool isComplete() const { return in_progress && complete; }
+    bool isHybrid() const { return hybrid; }
+    bool isPending() const { return in_progress && !complete; }
+
+ private:
+    UInt8 contacts_per_report = 1;
+    UInt8 maximum_contacts = 1;
+    bool has_identifiers = false;
+    bool hybrid = false;
+
+    bool in_progress = false;
+    bool complete = false;
+    UInt8 expected_contacts = 0;
+    UInt8 received_contacts = 0;
+    UInt8 report_contacts = 0;
+    UInt8 current_report = 0;
+    UInt32 contact_mask = 0;
+
+    uint64_t last_frame_start = 0;
+    uint64_t cadence_ns = FRAME_ASSEMBLER_DEFAULT_CADENCE_US * 1000ULL;
+};
+
+
+#endif /* VoodooI2CHIDFrameAssembler_hpp */
@@ -0,0 +1,147 @@
+//
+//  VoodooI2CHIDGestureRecognizer.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDGestureRecognizer.hpp"
+
+void VoodooI2CHIDGestureRecognizer::addEvent(VoodooI2CHIDGestureEvent* events, UInt8& count, VoodooI2CHIDGestureType type, AbsoluteTime timestamp, SInt32 delta_x, SInt32 delta_y) {
+    VoodooI2CHIDGestureEvent& event = events[count++];
+
+    if (!active[type]) {
+        active[type] = true;
+        recognised[type]++;
+        event.phase = kVoodooI2CHIDGestureBegan;
+    } else {
+        event.phase = kVoodooI2CHIDGestureChanged;
+    }
+
+    event.type = type;
+    event.timestamp = timestamp;
+    event.x = last_x;
+    event.y = last_y;
+    event.delta_x = delta_x;
+    event.delta_y = delta_y;
+    event.scale = start_distance ? static_cast<IOFixed>((static_cast<uint64_t>(distance) << 16) / start_distance) : 0x10000;
+    event.rotation = static_cast<IOFixed>(rotation);
+}
+
+UInt8 VoodooI2CHIDGestureRecognizer::end(AbsoluteTime timestamp, VoodooI2CHIDGestureEvent* events) {
+    UInt8 count = 0;
+
+    for (int type = kVoodooI2CHIDGesturePan; type <= kVoodooI2CHIDGestureRotate; type++) {
+        if (!active[type])
+            continue;
+
+        addEvent(events, count, static_cast<VoodooI2CHIDGestureType>(type), timestamp, 0, 0);
+        events[count - 1].phase = kVoodooI2CHIDGestureEnded;
+        active[type] = false;
+    }
+
+    tracking = false;
+
+    return count;
+}
+
+UInt32 VoodooI2CHIDGestureRecognizer::squareRoot(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return static_cast<UInt32>(root);
+}
+
+UInt8 VoodooI2CHIDGestureRecognizer::update(UInt32 identifier_a, IOFixed x_a, IOFixed y_a, UInt32 identifier_b, IOFixed x_b, IOFixed y_b, AbsoluteTime timestamp, VoodooI2CHIDGestureEvent* events) {
+    // Keep the contacts in identifier order so that the vector between them does not flip when the device reorders them
+    if (identifier_b < identifier_a) {
+        UInt32 identifier = identifier_a;
+        identifier_a = identifier_b;
+        identifier_b = identifier;
+
+        IOFixed coordinate = x_a;
+        x_a = x_b;
+        x_b = coordinate;
+
+        coordinate = y_a;
+        y_a = y_b;
+        y_b = coordinate;
+    }
+
+    UInt8 count = 0;
+
+    // Different fingers make a different gesture
+    if (tracking && (identifier_a != first_identifier || identifier_b != second_identifier))
+        count = end(timestamp, events);
+
+    IOFixed x = (x_a + x_b) / 2;
+    IOFixed y = (y_a + y_b) / 2;
+    SInt32 vector_x = x_b - x_a;
+    SInt32 vector_y = y_b - y_a;
+
+    distance = squareRoot(static_cast<uint64_t>(static_cast<SInt64>(vector_x) * vector_x + static_cast<SInt64>(vector_y) * vector_y));
+
+    if (!tracking) {
+        tracking = true;
+        first_identifier = identifier_a;
+        second_identifier = identifier_b;
+
+        start_x = last_x = x;
+        start_y = last_y = y;
+        start_distance = distance;
+        rotation = 0;
+
+        last_vector_x = vector_x;
+        last_vector_y = vector_y;
+
+        return count;
+    }
+
+    // The angle between consecutive vectors is small enough for atan(cross / dot) to be approximated by cross / dot
+    SInt64 cross = static_cast<SInt64>(last_vector_x) * vector_y - static_cast<SInt64>(last_vector_y) * vector_x;
+    SInt64 dot = static_cast<SInt64>(last_vector_x) * vector_x + static_cast<SInt64>(last_vector_y) * vector_y;
+
+    if (dot > 0)
+        rotation += (cross * 0x10000) / dot;
+
+    last_vector_x = vector_x;
+    last_vector_y = vector_y;
+
+    SInt32 delta_x = x - last_x;
+    SInt32 delta_y = y - last_y;
+    last_x = x;
+    last_y = y;
+
+    SInt32 pan_x = x - start_x;
+    SInt32 pan_y = y - start_y;
+    SInt32 pinch = static_cast<SInt32>(distance) - static_cast<SInt32>(start_distance);
+
+    // A pan that has just begun carries the movement that made it pass the threshold
+    if (active[kVoodooI2CHIDGesturePan])
+        addEvent(events, count, kVoodooI2CHIDGesturePan, timestamp, delta_x, delta_y);
+    else if (static_cast<SInt64>(pan_x) * pan_x + static_cast<SInt64>(pan_y) * pan_y > static_cast<SInt64>(GESTURE_PAN_THRESHOLD) * GESTURE_PAN_THRESHOLD)
+        addEvent(events, count, kVoodooI2CHIDGesturePan, timestamp, pan_x, pan_y);
+
+    if (active[kVoodooI2CHIDGesturePinch] || pinch > GESTURE_PINCH_THRESHOLD || pinch < -GESTURE_PINCH_THRESHOLD)
+        addEvent(events, count, kVoodooI2CHIDGesturePinch, timestamp, 0, 0);
+
+    if (active[kVoodooI2CHIDGestureRotate] || rotation > GESTURE_ROTATE_THRESHOLD || rotation < -GESTURE_ROTATE_THRESHOLD)
+        addEvent(events, count, kVoodooI2CHIDGestureRotate, timestamp, 0, 0);
+
+    return count;
+}
@@ -0,0 +1,130 @@
+//
+//  VoodooI2CHIDGestureRecognizer.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDGestureRecognizer_hpp
+#define VoodooI2CHIDGestureRecognizer_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+
+#define GESTURE_MAX_EVENTS          3
+#define GESTURE_PAN_THRESHOLD       1000        // 0 - 65535 range
+#define GESTURE_PINCH_THRESHOLD     1500        // 0 - 65535 range
+#define GESTURE_ROTATE_THRESHOLD    0x2CB8      // 10 degrees in 16.16 fixed point radians
+
+enum VoodooI2CHIDGestureType {
+    kVoodooI2CHIDGesturePan = 0,
+    kVoodooI2CHIDGesturePinch,
+    kVoodooI2CHIDGestureRotate
+};
+
+enum VoodooI2CHIDGesturePhase {
+    kVoodooI2CHIDGestureBegan = 0,
+    kVoodooI2CHIDGestureChanged,
+    kVoodooI2CHIDGestureEnded
+};
+
+struct VoodooI2CHIDGestureEvent {
+    VoodooI2CHIDGestureType type;
+    VoodooI2CHIDGesturePhase phase;
+    AbsoluteTime timestamp;
+    IOFixed x;              // Centroid of the contacts
+    IOFixed y;
+    SInt32 delta_x;         // Pan since the previous event
+    SInt32 delta_y;
+    IOFixed scale;          // Pinch since the gesture started, 16.16 fixed point
+    IOFixed rotation;       // Rotation since the gesture started, 16.16 fixed point radians
+};
+
+/* Recognises pan, pinch and rotate gestures from two contacts
+ *
+ * The centroid of the contacts gives the pan and the vector between them gives the pinch, as the ratio of its current
+ * length to its length at touch down, and the rotation, which is accumulated frame by frame from the cross and dot
+ * products of consecutive vectors. Each gesture begins once it passes its threshold and then changes with every frame
+ * until the contacts lift or change. Pinch and rotate may run at the same time, pan runs alongside both.
+ *
+ * The recogniser only works on integers and never allocates so that it can run for every frame, and it does not depend
+ * on anything but the IOKit types so that recorded traces can be replayed through it on any host.
+ */
+
+class VoodooI2CHIDGestureRecognizer {
+ public:
+    UInt32 recognised[3] = {};      // Indexed by <VoodooI2CHIDGestureType>
+
+    /* Feeds the two contacts of a frame
+     * @identifier_a The identifier of the first contact
+     * @x_a The X coordinate of the first contact in the 0 - 65535 range
+     * @y_a The Y coordinate of the first contact in the 0 - 65535 range
+     * @identifier_b The identifier of the second contact
+     * @x_b The X coordinate of the second contact in the 0 - 65535 range
+     * @y_b The Y coordinate of the second contact in the 0 - 65535 range
+     * @timestamp The timestamp of the frame
+     * @events Receives up to <GESTURE_MAX_EVENTS> events
+     *
+     * @return The number of events
+     */
+
+    UInt8 update(UInt32 identifier_a, IOFixed x_a, IOFixed y_a, UInt32 identifier_b, IOFixed x_b, IOFixed y_b, AbsoluteTime timestamp, VoodooI2CHIDGestureEvent* events);
+
+    /* Ends every running gesture
+     * @timestamp The timestamp of the frame in which the contacts lifted or changed
+     * @events Receives up to <GESTURE_MAX_EVENTS> events
+     *
+     * @return The number of events
+     */
+
+    UInt8 end(AbsoluteTime timestamp, VoodooI2CHIDGestureEvent* events);
+
+    /* Checks whether a gesture is running
+     * @type The gesture
+     *
+     * @return *true* if the gesture has begun and not ended yet
+     */
+
+    bool isActive(VoodooI2CHIDGestureType type) const { return active[type]; }
+
+ private:
+    bool tracking = false;
+    bool active[3] = {};
+
+    UInt32 first_identifier = 0;
+    UInt32 second_identifier = 0;
+
+    IOFixed start_x = 0;
+    IOFixed start_y = 0;
+    IOFixed last_x = 0;
+    IOFixed last_y = 0;
+
+    SInt32 last_vector_x = 0;
+    SInt32 last_vector_y = 0;
+    UInt32 start_distance = 0;
+    UInt32 distance = 0;
+    SInt64 rotation = 0;        // 16.16 fixed point radians
+
+    /* Appends an event for a gesture
+     * @events The event array
+     * @count The number of events in the array
+     * @type The gesture
+     * @timestamp The timestamp of the frame
+     * @delta_x The pan since the previous event
+     * @delta_y The pan since the previous event
+     */
+
+    void addEvent(VoodooI2CHIDGestureEvent* events, UInt8& count, VoodooI2CHIDGestureType type, AbsoluteTime timestamp, SInt32 delta_x, SInt32 delta_y);
+
+    /* Computes the integer square root
+     * @value The value
+     *
+     * @return The largest integer whose square does not exceed the value
+     */
+
+    static UInt32 squareRoot(uint64_t value);
+};
+
+
+#endif /* VoodooI2CHIDGestureRecognizer_hpp */
@@ -0,0 +1,35 @@
+//
+//  VoodooI2CHIDHoverCoalescer.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDHoverCoalescer.hpp"
+
+void VoodooI2CHIDHoverCoalescer::reset() {
+    has_last = false;
+}
+
+bool VoodooI2CHIDHoverCoalescer::shouldDispatch(UInt32 buttons, IOFixed x, IOFixed y, IOFixed x_tilt, IOFixed y_tilt) {
+    if (enabled && has_last && !buttons && !last_buttons && x_tilt == last_x_tilt && y_tilt == last_y_tilt) {
+        SInt32 dx = x - last_x;
+        SInt32 dy = y - last_y;
+
+        if (dx < static_cast<SInt32>(threshold) && dx > -static_cast<SInt32>(threshold) &&
+            dy < static_cast<SInt32>(threshold) && dy > -static_cast<SInt32>(threshold)) {
+            suppressed_events++;
+            return false;
+        }
+    }
+
+    has_last = true;
+    last_buttons = buttons;
+    last_x = x;
+    last_y = y;
+    last_x_tilt = x_tilt;
+    last_y_tilt = y_tilt;
+
+    return true;
+}
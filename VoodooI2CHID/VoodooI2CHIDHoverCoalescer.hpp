@@ -0,0 +1,66 @@
+//
+//  VoodooI2CHIDHoverCoalescer.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDHoverCoalescer_hpp
+#define VoodooI2CHIDHoverCoalescer_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+
+#define HOVER_COALESCER_DEFAULT_THRESHOLD 16        // 0 - 65535 range, below a pixel on common panels
+
+/* Drops stylus hover events that would not move the pointer
+ *
+ * A pen hovering over a 240 - 360 Hz digitiser reports far more positions than the event system needs. A hover event
+ * is dropped when the buttons and tilt are the same as in the last dispatched event and the position has moved less
+ * than <threshold> along either axis since then. Positions are compared against the last dispatched event so that slow
+ * movements still get through once they add up. Events with the tip or a button down and the first event after a
+ * button change are always dispatched.
+ */
+
+class VoodooI2CHIDHoverCoalescer {
+ public:
+    bool enabled = true;
+    UInt32 threshold = HOVER_COALESCER_DEFAULT_THRESHOLD;
+
+    UInt32 suppressed_events = 0;
+
+    /* Decides whether a stylus event should be dispatched
+     * @buttons The buttons of the event
+     * @x The X coordinate in the 0 - 65535 range
+     * @y The Y coordinate in the 0 - 65535 range
+     * @x_tilt The tilt along the X axis
+     * @y_tilt The tilt along the Y axis
+     *
+     * @return *true* if the event should be dispatched, *false* if it can be dropped
+     */
+
+    bool shouldDispatch(UInt32 buttons, IOFixed x, IOFixed y, IOFixed x_tilt, IOFixed y_tilt);
+
+    /* Checks whether a pen is being tracked
+     *
+     * @return *true* if an event was dispatched since the last reset, *false* otherwise
+     */
+
+    bool isTracking() const { return has_last; }
+
+    /* Forgets the last dispatched event, called once the pen leaves the range of the digitiser */
+
+    void reset();
+
+ private:
+    bool has_last = false;
+    UInt32 last_buttons = 0;
+    IOFixed last_x = 0;
+    IOFixed last_y = 0;
+    IOFixed last_x_tilt = 0;
+    IOFixed last_y_tilt = 0;
+};
+
+
+#endif /* VoodooI2CHIDHoverCoalescer_hpp */
@@ -0,0 +1,123 @@
+//
+//  VoodooI2CHIDInputPipeline.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDInputPipeline.hpp"
+
+static const char* phase_names[] = { "Acquire", "Decode", "Filter", "Track", "Dispatch" };
+
+bool VoodooI2CHIDInputPipeline::addStage(VoodooI2CHIDInputStage* stage, VoodooI2CHIDInputPhase phase) {
+    if (!stage || stage_count >= INPUT_PIPELINE_MAX_STAGES)
+        return false;
+
+    // Keep the stages sorted by phase, stages of the same phase run in the order they were added
+    int index = stage_count;
+
+    while (index > 0 && stages[index - 1].phase > phase) {
+        stages[index] = stages[index - 1];
+        index--;
+    }
+
+    memset(&stages[index], 0, sizeof(stages[index]));
+    stages[index].stage = stage;
+    stages[index].phase = phase;
+
+    stage_count++;
+
+    return true;
+}
+
+OSArray* VoodooI2CHIDInputPipeline::copyStatistics() {
+    OSArray* statistics = OSArray::withCapacity(stage_count);
+
+    if (!statistics)
+        return NULL;
+
+    for (int i = 0; i < stage_count; i++) {
+        OSDictionary* properties = OSDictionary::withCapacity(6);
+
+        if (!properties)
+            continue;
+
+        uint64_t average_ns = 0;
+        uint64_t max_ns = 0;
+
+        if (stages[i].frames)
+            absolutetime_to_nanoseconds(stages[i].total_time / stages[i].frames, &average_ns);
+
+        absolutetime_to_nanoseconds(stages[i].max_time, &max_ns);
+
+        OSString* string = OSString::withCString(stages[i].stage->getStageName());
+        properties->setObject("Name", string);
+        OSSafeReleaseNULL(string);
+
+        string = OSString::withCString(phase_names[stages[i].phase]);
+        properties->setObject("Phase", string);
+        OSSafeReleaseNULL(string);
+
+        OSNumber* number = OSNumber::withNumber(stages[i].frames, 32);
+        properties->setObject("Frames", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(stages[i].stopped_frames, 32);
+        properties->setObject("Stopped Frames", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(average_ns, 64);
+        properties->setObject("Average Time", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(max_ns, 64);
+        properties->setObject("Maximum Time", number);
+        OSSafeReleaseNULL(number);
+
+        statistics->setObject(properties);
+        properties->release();
+    }
+
+    return statistics;
+}
+
+void VoodooI2CHIDInputPipeline::resetStatistics() {
+    for (int i = 0; i < stage_count; i++) {
+        stages[i].frames = 0;
+        stages[i].stopped_frames = 0;
+        stages[i].total_time = 0;
+        stages[i].max_time = 0;
+    }
+}
+
+bool VoodooI2CHIDInputPipeline::run(VoodooI2CHIDInputFrame& frame, VoodooI2CHIDInputPhase first_phase) {
+    for (int i = 0; i < stage_count; i++) {
+        if (stages[i].phase < first_phase)
+            continue;
+
+        if (!timing) {
+            if (!stages[i].stage->processFrame(frame))
+                return false;
+
+            continue;
+        }
+
+        uint64_t start = mach_absolute_time();
+        bool result = stages[i].stage->processFrame(frame);
+        uint64_t elapsed = mach_absolute_time() - start;
+
+        stages[i].frames++;
+        stages[i].total_time += elapsed;
+
+        if (elapsed > stages[i].max_time)
+            stages[i].max_time = elapsed;
+
+        if (!result) {
+            stages[i].stopped_frames++;
+            return false;
+        }
+    }
+
+    return true;
+}
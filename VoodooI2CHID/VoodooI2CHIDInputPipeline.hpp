@@ -0,0 +1,138 @@
+//
+//  VoodooI2CHIDInputPipeline.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDInputPipeline_hpp
+#define VoodooI2CHIDInputPipeline_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <IOKit/IOMemoryDescriptor.h>
+#include <IOKit/hid/IOHIDDevice.h>
+#include <kern/clock.h>
+
+#include "../../../Multitouch Support/MultitouchHelpers.hpp"
+
+#define INPUT_PIPELINE_MAX_STAGES 16
+
+/* The phases of the input pipeline, stages run in phase order and in registration order within a phase */
+
+enum VoodooI2CHIDInputPhase {
+    kVoodooI2CHIDInputPhaseAcquire = 0,    // Gating of reports that should not be processed at all
+    kVoodooI2CHIDInputPhaseDecode,         // Turning reports into a complete frame of transducer values
+    kVoodooI2CHIDInputPhaseFilter,         // Rejecting or smoothing contacts of a complete frame
+    kVoodooI2CHIDInputPhaseTrack,          // Associating contacts across frames
+    kVoodooI2CHIDInputPhaseDispatch        // Delivering the frame to the multitouch interface
+};
+
+/* The state carried through the pipeline for a single input report */
+
+struct VoodooI2CHIDInputFrame {
+    AbsoluteTime timestamp;
+    IOMemoryDescriptor* report;
+    IOHIDReportType report_type;
+    UInt32 report_id;
+    VoodooI2CMultitouchEvent event;
+};
+
+/* A processing stage of the input pipeline */
+
+class VoodooI2CHIDInputStage {
+ public:
+    /* Returns the name the stage is published under */
+
+    virtual const char* getStageName() const = 0;
+
+    /* Processes a frame
+     * @frame The frame to be processed
+     *
+     * @return *true* if the frame should continue down the pipeline, *false* if processing of the frame ends here
+     */
+
+    virtual bool processFrame(VoodooI2CHIDInputFrame& frame) = 0;
+
+ protected:
+    ~VoodooI2CHIDInputStage() {}
+};
+
+/* Adapts a member function of a driver to the stage interface */
+
+template <class T>
+class VoodooI2CHIDMemberInputStage : public VoodooI2CHIDInputStage {
+ public:
+    typedef bool (T::*Action)(VoodooI2CHIDInputFrame& frame);
+
+    void bind(T* owner, Action action, const char* name) {
+        this->owner = owner;
+        this->action = action;
+        this->name = name;
+    }
+
+    const char* getStageName() const { return name; }
+
+    bool processFrame(VoodooI2CHIDInputFrame& frame) { return (owner->*action)(frame); }
+
+ private:
+    T* owner = NULL;
+    Action action = NULL;
+    const char* name = "";
+};
+
+/* Runs input frames through an ordered list of stages
+ *
+ * When <timing> is set, the time spent in every stage is accumulated so that the latency cost of a stage can be read
+ * back with <copyStatistics>. Timing is off by default and costs a single branch per stage when disabled.
+ */
+
+class VoodooI2CHIDInputPipeline {
+ public:
+    bool timing = false;
+
+    /* Adds a stage to the pipeline
+     * @stage The stage to be added, the pipeline does not take ownership of it
+     * @phase The phase in which the stage runs
+     *
+     * @return *true* on success, *false* if the pipeline is full
+     */
+
+    bool addStage(VoodooI2CHIDInputStage* stage, VoodooI2CHIDInputPhase phase);
+
+    /* Creates an array describing every stage along with its timing statistics
+     *
+     * @return An array of dictionaries. The caller must release the array.
+     */
+
+    OSArray* copyStatistics();
+
+    /* Clears the timing statistics of every stage */
+
+    void resetStatistics();
+
+    /* Runs a frame through the pipeline
+     * @frame The frame to be processed
+     * @first_phase The phase to start at, earlier stages are skipped
+     *
+     * @return *true* if the frame went through every stage, *false* if a stage ended processing of the frame
+     */
+
+    bool run(VoodooI2CHIDInputFrame& frame, VoodooI2CHIDInputPhase first_phase = kVoodooI2CHIDInputPhaseAcquire);
+
+ private:
+    struct {
+        VoodooI2CHIDInputStage* stage;
+        VoodooI2CHIDInputPhase phase;
+        UInt32 frames;
+        UInt32 stopped_frames;
+        uint64_t total_time;
+        uint64_t max_time;
+    } stages[INPUT_PIPELINE_MAX_STAGES];
+
+    UInt8 stage_count = 0;
+};
+
+
+#endif /* VoodooI2CHIDInputPipeline_hpp */
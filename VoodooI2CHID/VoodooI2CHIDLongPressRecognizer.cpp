@@ -0,0 +1,46 @@
+//
+//  VoodooI2CHIDLongPressRecognizer.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDLongPressRecognizer.hpp"
+
+void VoodooI2CHIDLongPressRecognizer::configure(UInt32 duration_ms, UInt32 radius_per_mille) {
+    nanoseconds_to_absolutetime(duration_ms * 1000000ULL, &duration);
+
+    uint64_t radius = (radius_per_mille * 65535ULL) / 1000;
+    radius_squared = radius * radius;
+
+    reset();
+}
+
+void VoodooI2CHIDLongPressRecognizer::reset() {
+    active = false;
+    recognised = false;
+}
+
+bool VoodooI2CHIDLongPressRecognizer::update(IOFixed x, IOFixed y, AbsoluteTime timestamp) {
+    SInt64 dx = static_cast<SInt64>(x) - anchor_x;
+    SInt64 dy = static_cast<SInt64>(y) - anchor_y;
+
+    if (!active || static_cast<uint64_t>(dx * dx + dy * dy) > radius_squared) {
+        // The contact touched down or moved on, it has to settle again
+        active = true;
+        recognised = false;
+        anchor_x = x;
+        anchor_y = y;
+        anchor_time = timestamp;
+
+        return false;
+    }
+
+    if (recognised || timestamp < anchor_time || timestamp - anchor_time < duration)
+        return false;
+
+    recognised = true;
+
+    return true;
+}
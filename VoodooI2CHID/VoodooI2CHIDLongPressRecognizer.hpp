@@ -0,0 +1,61 @@
+//
+//  VoodooI2CHIDLongPressRecognizer.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDLongPressRecognizer_hpp
+#define VoodooI2CHIDLongPressRecognizer_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <kern/clock.h>
+
+#define LONG_PRESS_DEFAULT_DURATION 1000    // ms
+#define LONG_PRESS_DEFAULT_RADIUS   10      // Per mille of the screen
+
+/* Recognises a finger resting on the screen for a while
+ *
+ * A long press fires once the contact has stayed within <radius> of the position it settled at for <duration>, measured
+ * with the frame timestamps so that it does not depend on the report rate of the panel. Moving further than the radius
+ * settles the contact again at its new position, sensor noise within the radius does not.
+ */
+
+class VoodooI2CHIDLongPressRecognizer {
+ public:
+    /* Sets the parameters of the recogniser
+     * @duration_ms How long the contact has to rest
+     * @radius_per_mille How far the contact may move while resting, in per mille of the 0 - 65535 range
+     */
+
+    void configure(UInt32 duration_ms, UInt32 radius_per_mille);
+
+    /* Feeds a new position of the contact
+     * @x The X coordinate in the 0 - 65535 range
+     * @y The Y coordinate in the 0 - 65535 range
+     * @timestamp The timestamp of the frame
+     *
+     * @return *true* for the frame on which the long press is recognised, *false* otherwise
+     */
+
+    bool update(IOFixed x, IOFixed y, AbsoluteTime timestamp);
+
+    /* Forgets the contact, the next position starts a new press */
+
+    void reset();
+
+ private:
+    AbsoluteTime duration = 0;
+    uint64_t radius_squared = 0;
+
+    bool active = false;
+    bool recognised = false;
+    IOFixed anchor_x = 0;
+    IOFixed anchor_y = 0;
+    AbsoluteTime anchor_time = 0;
+};
+
+
+#endif /* VoodooI2CHIDLongPressRecognizer_hpp */
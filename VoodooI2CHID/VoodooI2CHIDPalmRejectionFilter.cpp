@@ -0,0 +1,157 @@
+//
+//  VoodooI2CHIDPalmRejectionFilter.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDPalmRejectionFilter.hpp"
+
+VoodooI2CHIDPalmRejectionReason VoodooI2CHIDPalmRejectionFilter::classify(VoodooI2CDigitiserTransducer* transducer, contact_state& contact) {
+    if (contact.started_while_typing) {
+        if (isInTypingZone(transducer))
+            return kVoodooI2CHIDPalmRejectionTyping;
+
+        contact.started_while_typing = false;
+    }
+
+    if (!enabled)
+        return kVoodooI2CHIDPalmRejectionNone;
+
+    // Palms flicker in and out of low confidence and size limits, once rejected they stay rejected
+    if (contact.rejection == kVoodooI2CHIDPalmRejectionConfidence || contact.rejection == kVoodooI2CHIDPalmRejectionSize)
+        return contact.rejection;
+
+    if (!transducer->is_valid)
+        return kVoodooI2CHIDPalmRejectionConfidence;
+
+    if (max_size) {
+        uint64_t width = transducer->dimensions.width.value();
+        uint64_t height = transducer->dimensions.height.value();
+
+        // Width and Height are reported in a range of their own, which rarely matches that of X and Y
+        if ((logical_max_width && width * 1000 > static_cast<uint64_t>(max_size) * logical_max_width) ||
+            (logical_max_height && height * 1000 > static_cast<uint64_t>(max_size) * logical_max_height))
+            return kVoodooI2CHIDPalmRejectionSize;
+    }
+
+    if (contact.started_in_edge) {
+        if (isInEdgeZone(transducer))
+            return kVoodooI2CHIDPalmRejectionEdge;
+
+        contact.started_in_edge = false;
+    }
+
+    return kVoodooI2CHIDPalmRejectionNone;
+}
+
+bool VoodooI2CHIDPalmRejectionFilter::isInEdgeZone(VoodooI2CDigitiserTransducer* transducer) {
+    uint64_t x = static_cast<uint64_t>(transducer->coordinates.x.value()) * 1000;
+    uint64_t y = static_cast<uint64_t>(transducer->coordinates.y.value()) * 1000;
+
+    if (edge_zone && transducer->logical_max_x) {
+        uint64_t zone = static_cast<uint64_t>(edge_zone) * transducer->logical_max_x;
+
+        if (x < zone || x > static_cast<uint64_t>(transducer->logical_max_x) * 1000 - zone)
+            return true;
+    }
+
+    if (top_zone && transducer->logical_max_y && y < static_cast<uint64_t>(top_zone) * transducer->logical_max_y)
+        return true;
+
+    return false;
+}
+
+bool VoodooI2CHIDPalmRejectionFilter::isInTypingZone(VoodooI2CDigitiserTransducer* transducer) {
+    if (!typing_zone || !transducer->logical_max_y)
+        return false;
+
+    return static_cast<uint64_t>(transducer->coordinates.y.value()) * 1000 < static_cast<uint64_t>(typing_zone) * transducer->logical_max_y;
+}
+
+bool VoodooI2CHIDPalmRejectionFilter::processFrame(VoodooI2CHIDInputFrame& frame) {
+    if ((!enabled && !typing_zone) || !frame.event.transducers)
+        return true;
+
+    bool deliver = false;
+    int count = frame.event.transducers->getCount();
+    UInt8 fingers = 0;
+
+    for (int i = 0; i < count; i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, frame.event.transducers->getObject(i));
+
+        if (!transducer)
+            continue;
+
+        // Never hold back a frame that carries stylus data
+        if (transducer->type != kDigitiserTransducerFinger) {
+            deliver = true;
+            continue;
+        }
+
+        // Anything past the contact count is left over from earlier frames
+        if ((frame.event.contact_count && fingers >= frame.event.contact_count) || fingers >= PALM_REJECTION_MAX_CONTACTS)
+            break;
+
+        contact_state& contact = contacts[fingers++];
+
+        if (!transducer->tip_switch.value()) {
+            // The multitouch engines have to see a lift for every contact they have seen
+            if (contact.active && contact.delivered)
+                deliver = true;
+
+            memset(&contact, 0, sizeof(contact));
+            continue;
+        }
+
+        if (!contact.active || contact.identifier != transducer->secondary_id) {
+            memset(&contact, 0, sizeof(contact));
+            contact.active = true;
+            contact.identifier = transducer->secondary_id;
+            contact.started_in_edge = isInEdgeZone(transducer);
+            contact.started_while_typing = frame.timestamp < typing_until && isInTypingZone(transducer);
+        }
+
+        VoodooI2CHIDPalmRejectionReason rejection = classify(transducer, contact);
+
+        if (rejection != contact.rejection) {
+            switch (rejection) {
+                case kVoodooI2CHIDPalmRejectionConfidence:
+                    low_confidence_contacts++;
+                    break;
+                case kVoodooI2CHIDPalmRejectionSize:
+                    oversized_contacts++;
+                    break;
+                case kVoodooI2CHIDPalmRejectionEdge:
+                    edge_contacts++;
+                    break;
+                case kVoodooI2CHIDPalmRejectionTyping:
+                    typing_contacts++;
+                    break;
+                default:
+                    break;
+            }
+
+            contact.rejection = rejection;
+        }
+
+        if (rejection == kVoodooI2CHIDPalmRejectionNone)
+            contact.delivered = true;
+        else
+            transducer->is_valid = false;
+
+        deliver |= contact.delivered;
+    }
+
+    if (!deliver && fingers) {
+        stopped_frames++;
+        return false;
+    }
+
+    return true;
+}
+
+void VoodooI2CHIDPalmRejectionFilter::reset() {
+    memset(contacts, 0, sizeof(contacts));
+}
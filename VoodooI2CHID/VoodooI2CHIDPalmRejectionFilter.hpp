@@ -0,0 +1,108 @@
+//
+//  VoodooI2CHIDPalmRejectionFilter.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDPalmRejectionFilter_hpp
+#define VoodooI2CHIDPalmRejectionFilter_hpp
+
+#include "VoodooI2CHIDInputPipeline.hpp"
+
+#include "../../../Multitouch Support/VoodooI2CDigitiserTransducer.hpp"
+
+#define PALM_REJECTION_MAX_CONTACTS 16
+
+enum VoodooI2CHIDPalmRejectionReason {
+    kVoodooI2CHIDPalmRejectionNone = 0,
+    kVoodooI2CHIDPalmRejectionConfidence,
+    kVoodooI2CHIDPalmRejectionSize,
+    kVoodooI2CHIDPalmRejectionEdge,
+    kVoodooI2CHIDPalmRejectionTyping
+};
+
+/* Marks palms and other unintended contacts as invalid before they reach the multitouch engines
+ *
+ * A contact is rejected when the digitiser reports it with a low confidence, when its width or height exceeds
+ * <max_size> per mille of the logical range of the Width or Height usage, or when it lands within <edge_zone> per mille
+ * of the left and right edges or <top_zone> per mille of the top edge. Confidence and size rejections last until the contact is lifted since
+ * palms tend to flicker in and out of both. An edge rejection ends as soon as the contact leaves the zone it started in.
+ *
+ * Contacts that touch down within <typing_zone> per mille of the top edge, the one next to the keyboard, before
+ * <typing_until> are rejected in the same way as edge contacts. This replaces dropping every report after a key press
+ * and works even while the rest of the filter is disabled.
+ *
+ * Frames whose contacts have all been rejected since they touched down are stopped altogether, the multitouch engines
+ * have never seen any of them so there is nothing for them to update.
+ */
+
+class VoodooI2CHIDPalmRejectionFilter : public VoodooI2CHIDInputStage {
+ public:
+    bool enabled = false;
+
+    UInt16 max_size = 0;        // Per mille of the Width and Height ranges, 0 to disable
+    UInt16 edge_zone = 0;       // Per mille of the X axis on either side, 0 to disable
+    UInt16 top_zone = 0;        // Per mille of the Y axis, 0 to disable
+    UInt16 typing_zone = 0;     // Per mille of the Y axis, 0 to disable
+
+    AbsoluteTime typing_until = 0;
+
+    UInt32 logical_max_width = 0;
+    UInt32 logical_max_height = 0;
+
+    UInt32 low_confidence_contacts = 0;
+    UInt32 oversized_contacts = 0;
+    UInt32 edge_contacts = 0;
+    UInt32 typing_contacts = 0;
+    UInt32 stopped_frames = 0;
+
+    const char* getStageName() const { return "Palm Rejection"; }
+
+    bool processFrame(VoodooI2CHIDInputFrame& frame);
+
+    /* Forgets every contact */
+
+    void reset();
+
+ private:
+    struct contact_state {
+        bool active;
+        bool delivered;
+        bool started_in_edge;
+        bool started_while_typing;
+        VoodooI2CHIDPalmRejectionReason rejection;
+        UInt32 identifier;
+    };
+
+    contact_state contacts[PALM_REJECTION_MAX_CONTACTS] = {};
+
+    /* Decides whether a contact should be rejected
+     * @transducer The contact
+     * @contact The state of the contact
+     *
+     * @return The reason the contact is rejected for, <kVoodooI2CHIDPalmRejectionNone> if it is not
+     */
+
+    VoodooI2CHIDPalmRejectionReason classify(VoodooI2CDigitiserTransducer* transducer, contact_state& contact);
+
+    /* Checks whether a contact lies in one of the edge zones
+     * @transducer The contact
+     *
+     * @return *true* if the contact is within an edge zone, *false* otherwise
+     */
+
+    bool isInEdgeZone(VoodooI2CDigitiserTransducer* transducer);
+
+    /* Checks whether a contact lies in the zone next to the keyboard
+     * @transducer The contact
+     *
+     * @return *true* if the contact is within the typing zone, *false* otherwise
+     */
+
+    bool isInTypingZone(VoodooI2CDigitiserTransducer* transducer);
+};
+
+
+#endif /* VoodooI2CHIDPalmRejectionFilter_hpp */
@@ -0,0 +1,68 @@
+//
+//  VoodooI2CHIDPressureCurve.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDPressureCurve.hpp"
+
+bool VoodooI2CHIDPressureCurve::configure(const UInt16* inputs, const UInt16* outputs, UInt8 count) {
+    static const UInt16 linear[2] = {0, 1000};
+
+    if (!count) {
+        inputs = linear;
+        outputs = linear;
+        count = 2;
+    }
+
+    if (count > PRESSURE_CURVE_MAX_POINTS)
+        return false;
+
+    for (int i = 0; i < count; i++) {
+        if (inputs[i] > 1000 || outputs[i] > 1000 || (i && inputs[i] <= inputs[i - 1]))
+            return false;
+    }
+
+    UInt8 next = active ^ 1;
+    UInt16* table = tables[next];
+    int point = 0;
+
+    // The identity is mapped exactly without going through the table
+    identity[next] = inputs[0] == 0 && inputs[count - 1] == 1000;
+
+    for (int i = 0; i < count; i++)
+        identity[next] = identity[next] && inputs[i] == outputs[i];
+
+    for (UInt32 level = 0; level <= PRESSURE_CURVE_LEVELS; level++) {
+        // The last entry lies just past the range and is only used as the upper end when interpolating near its top
+        UInt32 input = (level << PRESSURE_CURVE_SHIFT) * 1000;     // Per mille, scaled by 65535
+
+        while (point < count && static_cast<UInt32>(inputs[point]) * 65535 <= input)
+            point++;
+
+        UInt32 output;
+
+        if (point == 0) {
+            output = outputs[0] * 65535;
+        } else if (point == count) {
+            output = outputs[count - 1] * 65535;
+        } else {
+            UInt32 x0 = inputs[point - 1] * 65535;
+            UInt32 x1 = inputs[point] * 65535;
+            SInt64 y0 = outputs[point - 1] * 65535;
+            SInt64 y1 = outputs[point] * 65535;
+
+            output = static_cast<UInt32>(y0 + ((y1 - y0) * (input - x0)) / (x1 - x0));
+        }
+
+        table[level] = static_cast<UInt16>((output + 500) / 1000);
+    }
+
+    // The table has to be complete before it is used
+    OSMemoryBarrier();
+    active ^= 1;
+
+    return true;
+}
@@ -0,0 +1,73 @@
+//
+//  VoodooI2CHIDPressureCurve.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDPressureCurve_hpp
+#define VoodooI2CHIDPressureCurve_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <libkern/OSAtomic.h>
+
+#define PRESSURE_CURVE_SHIFT      4
+#define PRESSURE_CURVE_LEVELS     (65536 >> PRESSURE_CURVE_SHIFT)
+#define PRESSURE_CURVE_MAX_POINTS 16
+
+/* Maps stylus pressure through a response curve
+ *
+ * The curve is given as control points in per mille of the input and output ranges and interpolated linearly between
+ * them, the first and last outputs extend to either end of the range. It is sampled into a table of
+ * <PRESSURE_CURVE_LEVELS> + 1 entries, one every 2^<PRESSURE_CURVE_SHIFT> pressure steps, and mapping a pressure
+ * interpolates between the two entries around it so no resolution is lost. The linear curve skips the table.
+ *
+ * A new curve is compiled into the table that is not in use and then swapped in, pressure mapped meanwhile still goes
+ * through the previous curve. Compiling is not reentrant, callers serialise it.
+ */
+
+class VoodooI2CHIDPressureCurve {
+ public:
+    VoodooI2CHIDPressureCurve() { configure(NULL, NULL, 0); }
+
+    /* Compiles a curve
+     * @inputs The inputs of the control points in per mille, strictly increasing
+     * @outputs The outputs of the control points in per mille
+     * @count The number of control points, 0 for a linear curve
+     *
+     * @return *true* if the curve was compiled, *false* if the control points are invalid and the previous curve is kept
+     */
+
+    bool configure(const UInt16* inputs, const UInt16* outputs, UInt8 count);
+
+    /* Maps a pressure through the curve
+     * @pressure The pressure in the 0 - 65535 range
+     *
+     * @return The mapped pressure in the 0 - 65535 range
+     */
+
+    IOFixed apply(IOFixed pressure) const {
+        UInt8 table = active;
+
+        if (static_cast<UInt32>(pressure) > 65535)
+            pressure = pressure < 0 ? 0 : 65535;
+
+        if (identity[table])
+            return pressure;
+
+        SInt32 low = tables[table][pressure >> PRESSURE_CURVE_SHIFT];
+        SInt32 high = tables[table][(pressure >> PRESSURE_CURVE_SHIFT) + 1];
+
+        return low + ((high - low) * (pressure & ((1 << PRESSURE_CURVE_SHIFT) - 1))) / (1 << PRESSURE_CURVE_SHIFT);
+    }
+
+ private:
+    UInt16 tables[2][PRESSURE_CURVE_LEVELS + 1];
+    bool identity[2] = {};
+    volatile UInt8 active = 0;
+};
+
+
+#endif /* VoodooI2CHIDPressureCurve_hpp */
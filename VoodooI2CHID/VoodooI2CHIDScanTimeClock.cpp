@@ -0,0 +1,101 @@
+//
+//  VoodooI2CHIDScanTimeClock.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDScanTimeClock.hpp"
+
+AbsoluteTime VoodooI2CHIDScanTimeClock::convert(UInt16 scan_time, AbsoluteTime timestamp) {
+    uint64_t host_ns;
+    absolutetime_to_nanoseconds(timestamp, &host_ns);
+
+    if (!synchronised || host_ns <= last_host_ns || host_ns - last_host_ns > SCAN_TIME_MAX_GAP_NS) {
+        resynchronise(host_ns);
+    } else {
+        UInt16 ticks = scan_time - last_scan_time;
+        SInt64 device_delta = static_cast<SInt64>(ticks * SCAN_TIME_UNIT_NS);
+        SInt64 divergence = device_delta - static_cast<SInt64>(host_ns - last_host_ns);
+
+        if (divergence > SCAN_TIME_MAX_DIVERGENCE_NS || divergence < -SCAN_TIME_MAX_DIVERGENCE_NS) {
+            // The counter was restarted or we missed a wrap
+            resynchronise(host_ns);
+        } else {
+            device_ns += device_delta;
+
+            SInt64 sample = static_cast<SInt64>(host_ns - device_ns);
+
+            if (sample < offset_ns)
+                offset_ns = sample;
+            else
+                offset_ns += (sample - offset_ns) >> 8;
+        }
+    }
+
+    last_scan_time = scan_time;
+    last_host_ns = host_ns;
+
+    uint64_t aligned_ns = device_ns + offset_ns;
+
+    // Never report a frame before the previous one
+    if (aligned_ns <= last_aligned_ns)
+        aligned_ns = last_aligned_ns + 1;
+
+    if (aligned_ns > host_ns)
+        aligned_ns = host_ns;
+
+    last_aligned_ns = aligned_ns;
+
+    UInt32 correction_us = static_cast<UInt32>((host_ns - aligned_ns) / 1000);
+
+    if (correction_us > session_correction_us)
+        session_correction_us = correction_us;
+
+    // The offset needs a few frames to find its envelope before it is a useful reference for the skew
+    if (!settled && host_ns - session_start_ns >= SCAN_TIME_SETTLE_NS) {
+        settled = true;
+        session_start_ns = host_ns;
+        session_offset_ns = offset_ns;
+    }
+
+    uint64_t aligned;
+    nanoseconds_to_absolutetime(aligned_ns, &aligned);
+
+    return aligned;
+}
+
+void VoodooI2CHIDScanTimeClock::finishSession() {
+    if (!synchronised || !settled || last_host_ns - session_start_ns < SCAN_TIME_MIN_SESSION_NS)
+        return;
+
+    // A device clock that runs fast makes the offset shrink
+    SInt64 drift_ns = session_offset_ns - offset_ns;
+    SInt64 elapsed_ns = static_cast<SInt64>(last_host_ns - session_start_ns);
+
+    skew_ppm = static_cast<SInt32>((drift_ns * 1000000LL) / elapsed_ns);
+    maximum_correction_us = session_correction_us;
+    measurements++;
+}
+
+void VoodooI2CHIDScanTimeClock::reset() {
+    synchronised = false;
+}
+
+void VoodooI2CHIDScanTimeClock::resynchronise(uint64_t host_ns) {
+    finishSession();
+
+    if (synchronised)
+        resynchronisations++;
+
+    synchronised = true;
+    settled = false;
+
+    device_ns = 0;
+    offset_ns = static_cast<SInt64>(host_ns);
+
+    session_start_ns = host_ns;
+    session_offset_ns = offset_ns;
+    session_correction_us = 0;
+}
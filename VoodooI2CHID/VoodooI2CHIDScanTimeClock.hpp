@@ -0,0 +1,82 @@
+//
+//  VoodooI2CHIDScanTimeClock.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDScanTimeClock_hpp
+#define VoodooI2CHIDScanTimeClock_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <kern/clock.h>
+
+#define SCAN_TIME_UNIT_NS           100000ULL       // Scan Time counts in 100 µs units
+#define SCAN_TIME_MAX_GAP_NS        3000000000ULL   // Below half of the 6.5 s wrap period of the counter
+#define SCAN_TIME_MAX_DIVERGENCE_NS 20000000LL
+#define SCAN_TIME_SETTLE_NS         250000000ULL
+#define SCAN_TIME_MIN_SESSION_NS    1000000000ULL
+
+/* Maps the Scan Time of a digitiser onto host uptime
+ *
+ * The 16-bit Scan Time counter is unwrapped into a continuous device time. The offset between that time and the host
+ * arrival time of the reports follows the lower envelope of the observed offsets, which are the reports that suffered
+ * the least bus and scheduling delay, and slowly creeps upwards to follow a device clock that runs slow. The clock is
+ * resynchronised whenever the device time cannot be trusted anymore: after long idle periods, which also covers devices
+ * that restart Scan Time with every touch, and whenever device and host time diverge.
+ *
+ * The skew of the device clock against host uptime is measured over every session that lasted long enough to give a
+ * meaningful result.
+ */
+
+class VoodooI2CHIDScanTimeClock {
+ public:
+    UInt32 resynchronisations = 0;
+    UInt32 measurements = 0;
+
+    SInt32 skew_ppm = 0;
+    UInt32 maximum_correction_us = 0;
+
+    /* Converts a Scan Time value to host time
+     * @scan_time The Scan Time reported by the device
+     * @timestamp The host time the report arrived at
+     *
+     * @return The host time at which the device scanned the frame
+     */
+
+    AbsoluteTime convert(UInt16 scan_time, AbsoluteTime timestamp);
+
+    /* Forgets the current alignment so that the next report resynchronises the clock */
+
+    void reset();
+
+ private:
+    bool synchronised = false;
+
+    UInt16 last_scan_time = 0;
+    uint64_t last_host_ns = 0;
+    uint64_t last_aligned_ns = 0;
+
+    uint64_t device_ns = 0;
+    SInt64 offset_ns = 0;
+
+    bool settled = false;
+    uint64_t session_start_ns = 0;
+    SInt64 session_offset_ns = 0;
+    UInt32 session_correction_us = 0;
+
+    /* Publishes the skew of the session that just ended if it lasted long enough */
+
+    void finishSession();
+
+    /* Starts a new session at the given host time
+     * @host_ns The host time of the report starting the session
+     */
+
+    void resynchronise(uint64_t host_ns);
+};
+
+
+#endif /* VoodooI2CHIDScanTimeClock_hpp */
@@ -0,0 +1,98 @@
+//
+//  VoodooI2CHIDSmoothingFilter.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDSmoothingFilter.hpp"
+
+// 10^12 / 2π, the time constant in ns of a filter with a 1 mHz cutoff
+#define TIME_CONSTANT_NS_MHZ 159154943092ULL
+
+void VoodooI2CHIDSmoothingFilter::configure(UInt32 min_cutoff, UInt32 beta, UInt32 derivative_cutoff) {
+    this->min_cutoff = min_cutoff ? min_cutoff : 1;
+    this->beta = beta;
+    this->derivative_cutoff = derivative_cutoff ? derivative_cutoff : 1;
+
+    memset(contacts, 0, sizeof(contacts));
+}
+
+UInt32 VoodooI2CHIDSmoothingFilter::smoothingFactor(uint64_t interval_ns, UInt32 cutoff) {
+    uint64_t time_constant_ns = TIME_CONSTANT_NS_MHZ / cutoff;
+
+    return static_cast<UInt32>((interval_ns << 16) / (interval_ns + time_constant_ns));
+}
+
+UInt32 VoodooI2CHIDSmoothingFilter::filterAxis(axis_state& state, UInt32 value, uint64_t interval_ns) {
+    SInt64 raw = static_cast<SInt64>(value) << 8;
+
+    // Estimate the speed first, it decides how much smoothing the position gets
+    SInt64 speed = ((raw - state.value) * 1000000000LL / static_cast<SInt64>(interval_ns)) >> 8;
+    SInt64 derivative_alpha = smoothingFactor(interval_ns, derivative_cutoff);
+    state.speed += ((speed - state.speed) * derivative_alpha) >> 16;
+
+    uint64_t absolute_speed = state.speed < 0 ? -state.speed : state.speed;
+    uint64_t cutoff = min_cutoff + beta * absolute_speed;
+
+    if (cutoff > UINT32_MAX)
+        cutoff = UINT32_MAX;
+
+    SInt64 alpha = smoothingFactor(interval_ns, static_cast<UInt32>(cutoff));
+    state.value += ((raw - state.value) * alpha) >> 16;
+
+    return static_cast<UInt32>((state.value + 0x80) >> 8);
+}
+
+bool VoodooI2CHIDSmoothingFilter::processFrame(VoodooI2CHIDInputFrame& frame) {
+    if (!enabled || !frame.event.transducers)
+        return true;
+
+    uint64_t now = frame.timestamp;
+    int count = frame.event.transducers->getCount();
+
+    if (count > SMOOTHING_FILTER_MAX_CONTACTS)
+        count = SMOOTHING_FILTER_MAX_CONTACTS;
+
+    for (int i = 0; i < count; i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, frame.event.transducers->getObject(i));
+        contact_state& contact = contacts[i];
+
+        if (!transducer || transducer->type != kDigitiserTransducerFinger)
+            continue;
+
+        if (!transducer->tip_switch.value()) {
+            contact.active = false;
+            continue;
+        }
+
+        UInt32 x = transducer->coordinates.x.value();
+        UInt32 y = transducer->coordinates.y.value();
+
+        uint64_t interval_ns = 0;
+
+        if (contact.active && now > contact.timestamp)
+            absolutetime_to_nanoseconds(now - contact.timestamp, &interval_ns);
+
+        // A new contact, or one we have not heard from in a while, starts out unfiltered
+        if (!contact.active || contact.identifier != transducer->secondary_id || !interval_ns || interval_ns > SMOOTHING_FILTER_MAX_INTERVAL_NS) {
+            contact.active = true;
+            contact.identifier = transducer->secondary_id;
+            contact.timestamp = now;
+            contact.x.value = static_cast<SInt64>(x) << 8;
+            contact.x.speed = 0;
+            contact.y.value = static_cast<SInt64>(y) << 8;
+            contact.y.speed = 0;
+            continue;
+        }
+
+        contact.timestamp = now;
+
+        // Only the current value is replaced, the previous one stays what the multitouch engine saw last frame
+        transducer->coordinates.x.current.value = filterAxis(contact.x, x, interval_ns);
+        transducer->coordinates.y.current.value = filterAxis(contact.y, y, interval_ns);
+    }
+
+    return true;
+}
@@ -0,0 +1,87 @@
+//
+//  VoodooI2CHIDSmoothingFilter.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDSmoothingFilter_hpp
+#define VoodooI2CHIDSmoothingFilter_hpp
+
+#include "VoodooI2CHIDInputPipeline.hpp"
+
+#include "../../../Multitouch Support/VoodooI2CDigitiserTransducer.hpp"
+
+#define SMOOTHING_FILTER_MAX_CONTACTS              16
+#define SMOOTHING_FILTER_DEFAULT_MIN_CUTOFF        1000    // mHz
+#define SMOOTHING_FILTER_DEFAULT_BETA              7       // mHz per logical unit per second
+#define SMOOTHING_FILTER_DEFAULT_DERIVATIVE_CUTOFF 1000    // mHz
+#define SMOOTHING_FILTER_MAX_INTERVAL_NS           100000000ULL
+
+/* Smooths finger coordinates with a fixed-point One Euro filter
+ *
+ * The One Euro filter is a first order low-pass filter whose cutoff frequency rises with the speed of the contact. Slow
+ * movements are heavily smoothed to remove jitter while fast movements are barely delayed. Coordinates are filtered
+ * per axis in 24.8 fixed point, the smoothing factors are computed in 16.16 fixed point from the frame interval so that
+ * no floating point is needed in the interrupt path.
+ */
+
+class VoodooI2CHIDSmoothingFilter : public VoodooI2CHIDInputStage {
+ public:
+    bool enabled = false;
+
+    /* Sets the filter parameters
+     * @min_cutoff The cutoff frequency in mHz of a stationary contact
+     * @beta How quickly in mHz per logical unit per second the cutoff frequency rises with speed
+     * @derivative_cutoff The cutoff frequency in mHz used to smooth the speed estimate
+     */
+
+    void configure(UInt32 min_cutoff, UInt32 beta, UInt32 derivative_cutoff);
+
+    const char* getStageName() const { return "Smoothing"; }
+
+    bool processFrame(VoodooI2CHIDInputFrame& frame);
+
+ private:
+    struct axis_state {
+        SInt64 value;       // 24.8 fixed point
+        SInt64 speed;       // Logical units per second
+    };
+
+    struct contact_state {
+        bool active;
+        UInt32 identifier;
+        uint64_t timestamp;
+        axis_state x;
+        axis_state y;
+    };
+
+    UInt32 min_cutoff = SMOOTHING_FILTER_DEFAULT_MIN_CUTOFF;
+    UInt32 beta = SMOOTHING_FILTER_DEFAULT_BETA;
+    UInt32 derivative_cutoff = SMOOTHING_FILTER_DEFAULT_DERIVATIVE_CUTOFF;
+
+    contact_state contacts[SMOOTHING_FILTER_MAX_CONTACTS] = {};
+
+    /* Computes the smoothing factor of a low-pass filter
+     * @interval_ns The time since the previous sample
+     * @cutoff The cutoff frequency in mHz
+     *
+     * @return The smoothing factor in 16.16 fixed point
+     */
+
+    static UInt32 smoothingFactor(uint64_t interval_ns, UInt32 cutoff);
+
+    /* Filters a single axis
+     * @state The state of the axis
+     * @value The raw value of the axis
+     * @interval_ns The time since the previous sample
+     *
+     * @return The filtered value
+     */
+
+    UInt32 filterAxis(axis_state& state, UInt32 value, uint64_t interval_ns);
+};
+
+
+#endif /* VoodooI2CHIDSmoothingFilter_hpp */
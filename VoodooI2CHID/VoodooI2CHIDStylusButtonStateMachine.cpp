@@ -0,0 +1,84 @@
+//
+//  VoodooI2CHIDStylusButtonStateMachine.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDStylusButtonStateMachine.hpp"
+
+#define SWITCH_TIP    0x1
+#define SWITCH_BARREL 0x2
+#define SWITCH_ERASER 0x4
+#define SWITCH_INVERT 0x8
+
+#define DEBOUNCED_SWITCHES (SWITCH_BARREL | SWITCH_INVERT)
+
+#define H  kVoodooI2CHIDStylusHover
+#define HB kVoodooI2CHIDStylusHoverBarrel
+#define HI kVoodooI2CHIDStylusHoverInverted
+#define T  kVoodooI2CHIDStylusTip
+#define TB kVoodooI2CHIDStylusTipBarrel
+#define ER kVoodooI2CHIDStylusErasing
+
+// Indexed by the current state and a combination of the SWITCH_ bits
+static const UInt8 transitions[6][16] = {
+    //        -   T   B   TB  E   TE  BE  TBE I   TI  BI  TBI EI  TEI BEI TBEI
+    /* H  */ {H , T , HB, TB, ER, ER, ER, ER, HI, ER, HI, ER, ER, ER, ER, ER},
+    /* HB */ {H , TB, HB, TB, ER, ER, ER, ER, HI, ER, HI, ER, ER, ER, ER, ER},
+    /* HI */ {H , ER, HB, ER, ER, ER, ER, ER, HI, ER, HI, ER, ER, ER, ER, ER},
+    /* T  */ {H , T , HB, T , ER, ER, ER, ER, HI, T , HI, T , ER, ER, ER, ER},
+    /* TB */ {H , TB, HB, TB, ER, ER, ER, ER, HI, TB, HI, TB, ER, ER, ER, ER},
+    /* ER */ {H , ER, HB, ER, ER, ER, ER, ER, HI, ER, HI, ER, ER, ER, ER, ER},
+};
+
+// Indexed by the state
+static const UInt32 buttons[6] = {
+    0,                      // Hover
+    STYLUS_BUTTON_BARREL,   // Hover with the barrel switch held
+    0,                      // Hover with the eraser end
+    STYLUS_BUTTON_TIP,      // Tip
+    STYLUS_BUTTON_BARREL,   // Tip with the barrel switch held as it landed
+    STYLUS_BUTTON_ERASER    // Eraser
+};
+
+#undef H
+#undef HB
+#undef HI
+#undef T
+#undef TB
+#undef ER
+
+void VoodooI2CHIDStylusButtonStateMachine::configure(UInt32 debounce_ms) {
+    nanoseconds_to_absolutetime(debounce_ms * 1000000ULL, &debounce);
+
+    reset();
+}
+
+void VoodooI2CHIDStylusButtonStateMachine::reset() {
+    state = kVoodooI2CHIDStylusHover;
+    stable_switches = 0;
+    pending_switches = 0;
+}
+
+UInt32 VoodooI2CHIDStylusButtonStateMachine::update(bool tip, bool barrel, bool eraser, bool invert, AbsoluteTime timestamp) {
+    UInt8 debounced = (barrel ? SWITCH_BARREL : 0) | (invert ? SWITCH_INVERT : 0);
+
+    // A switch has to hold a new value for the debounce time before it counts
+    if (debounced == stable_switches) {
+        pending_switches = stable_switches;
+    } else if (debounced != pending_switches) {
+        pending_switches = debounced;
+        pending_since = timestamp;
+    }
+
+    if (pending_switches != stable_switches && (timestamp < pending_since || timestamp - pending_since >= debounce))
+        stable_switches = pending_switches;
+
+    UInt8 switches = stable_switches | (tip ? SWITCH_TIP : 0) | (eraser ? SWITCH_ERASER : 0);
+
+    state = static_cast<VoodooI2CHIDStylusButtonState>(transitions[state][switches]);
+
+    return buttons[state];
+}
@@ -0,0 +1,81 @@
+//
+//  VoodooI2CHIDStylusButtonStateMachine.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDStylusButtonStateMachine_hpp
+#define VoodooI2CHIDStylusButtonStateMachine_hpp
+
+#include <IOKit/IOLib.h>
+#include <IOKit/IOTypes.h>
+#include <kern/clock.h>
+
+#define STYLUS_BUTTON_DEFAULT_DEBOUNCE 10  // ms
+
+#define STYLUS_BUTTON_TIP    0x1
+#define STYLUS_BUTTON_BARREL 0x2
+#define STYLUS_BUTTON_ERASER 0x4
+
+enum VoodooI2CHIDStylusButtonState {
+    kVoodooI2CHIDStylusHover = 0,
+    kVoodooI2CHIDStylusHoverBarrel,
+    kVoodooI2CHIDStylusHoverInverted,
+    kVoodooI2CHIDStylusTip,
+    kVoodooI2CHIDStylusTipBarrel,
+    kVoodooI2CHIDStylusErasing
+};
+
+/* Works out the buttons of a pen from its tip, barrel, eraser and invert switches
+ *
+ * The switches of a frame select a transition from the state the pen is in, the new state gives the buttons. A barrel
+ * switch held as the tip lands makes a secondary drag that lasts until the tip lifts, pressing it mid stroke does not
+ * turn a drag into a different one. The eraser end is recognised from either the Eraser switch or a Tip Switch while
+ * inverted and stays in use until it lifts, since some firmware clears Invert as soon as the eraser touches. The Eraser
+ * switch wins over a Tip Switch reported along with it.
+ *
+ * The barrel and invert switches have to hold their value for <debounce> before the state machine sees them so that a
+ * bouncing side button does not click. The tip and eraser switches are thresholded by the firmware already and go
+ * through right away. Everything is forgotten once the pen leaves the range of the digitiser.
+ */
+
+class VoodooI2CHIDStylusButtonStateMachine {
+ public:
+    /* Sets the debounce time of the barrel and invert switches
+     * @debounce_ms How long a switch has to hold its value, 0 to disable
+     */
+
+    void configure(UInt32 debounce_ms);
+
+    /* Feeds the switches of a frame
+     * @tip The Tip Switch
+     * @barrel The Barrel Switch
+     * @eraser The Eraser switch
+     * @invert The Invert switch
+     * @timestamp The timestamp of the frame
+     *
+     * @return The buttons, a combination of <STYLUS_BUTTON_TIP>, <STYLUS_BUTTON_BARREL> and <STYLUS_BUTTON_ERASER>
+     */
+
+    UInt32 update(bool tip, bool barrel, bool eraser, bool invert, AbsoluteTime timestamp);
+
+    /* Forgets the pen, called once it has left the range of the digitiser */
+
+    void reset();
+
+    VoodooI2CHIDStylusButtonState getState() const { return state; }
+
+ private:
+    AbsoluteTime debounce = 0;
+
+    VoodooI2CHIDStylusButtonState state = kVoodooI2CHIDStylusHover;
+
+    UInt8 stable_switches = 0;          // Debounced barrel and invert switches
+    UInt8 pending_switches = 0;
+    AbsoluteTime pending_since = 0;
+};
+
+
+#endif /* VoodooI2CHIDStylusButtonStateMachine_hpp */
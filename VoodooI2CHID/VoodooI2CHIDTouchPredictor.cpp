@@ -0,0 +1,133 @@
+//
+//  VoodooI2CHIDTouchPredictor.cpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#include "VoodooI2CHIDTouchPredictor.hpp"
+
+#define NSEC_PER_SEC_S64 1000000000LL
+
+// Bounds on the motion estimate, well beyond anything a finger does but low enough to keep the math from overflowing
+#define MAX_VELOCITY     10000000LL
+#define MAX_ACCELERATION 10000000000LL
+
+static inline SInt64 clamp(SInt64 value, SInt64 limit) {
+    return value > limit ? limit : (value < -limit ? -limit : value);
+}
+
+bool VoodooI2CHIDTouchPredictor::processFrame(VoodooI2CHIDInputFrame& frame) {
+    if (!enabled || !interval_ms || !frame.event.transducers)
+        return true;
+
+    uint64_t now = frame.timestamp;
+    int count = frame.event.transducers->getCount();
+
+    if (count > TOUCH_PREDICTOR_MAX_CONTACTS)
+        count = TOUCH_PREDICTOR_MAX_CONTACTS;
+
+    for (int i = 0; i < count; i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, frame.event.transducers->getObject(i));
+        contact_state& contact = contacts[i];
+
+        if (!transducer || transducer->type != kDigitiserTransducerFinger)
+            continue;
+
+        if (!transducer->tip_switch.value()) {
+            contact.samples = 0;
+            continue;
+        }
+
+        SInt64 x = transducer->coordinates.x.value();
+        SInt64 y = transducer->coordinates.y.value();
+
+        uint64_t interval_ns = 0;
+
+        if (contact.samples && now > contact.timestamp)
+            absolutetime_to_nanoseconds(now - contact.timestamp, &interval_ns);
+
+        // Nothing to extrapolate from for a new contact or one we have not heard from in a while
+        if (!contact.samples || contact.identifier != transducer->secondary_id || !interval_ns || interval_ns > TOUCH_PREDICTOR_MAX_SAMPLE_NS) {
+            memset(&contact, 0, sizeof(contact));
+            contact.samples = 1;
+            contact.gain = TOUCH_PREDICTOR_FULL_GAIN;
+            contact.identifier = transducer->secondary_id;
+            contact.timestamp = now;
+            contact.x.position = x;
+            contact.y.position = y;
+            continue;
+        }
+
+        bool has_velocity = contact.samples >= 2;
+
+        // Jitter across the direction of travel flips the sign of the other axis all the time, only a reversal on an
+        // axis that carried a fair share of the motion counts
+        SInt64 speed_x = contact.x.velocity < 0 ? -contact.x.velocity : contact.x.velocity;
+        SInt64 speed_y = contact.y.velocity < 0 ? -contact.y.velocity : contact.y.velocity;
+
+        bool reversed = updateAxis(contact.x, x, interval_ns) && has_velocity && speed_x * 4 >= speed_y;
+        reversed |= updateAxis(contact.y, y, interval_ns) && has_velocity && speed_y * 4 >= speed_x;
+
+        if (contact.samples < 3)
+            contact.samples++;
+
+        contact.timestamp = now;
+
+        if (reversed)
+            contact.gain = 0;
+        else if (contact.gain < TOUCH_PREDICTOR_FULL_GAIN)
+            contact.gain += TOUCH_PREDICTOR_GAIN_RECOVERY;
+
+        // Acceleration is only meaningful once we have seen two velocities
+        if (contact.samples < 3) {
+            contact.x.acceleration = 0;
+            contact.y.acceleration = 0;
+        }
+
+        transducer->coordinates.x.current.value = predictAxis(contact.x, contact.gain, transducer->logical_max_x);
+        transducer->coordinates.y.current.value = predictAxis(contact.y, contact.gain, transducer->logical_max_y);
+    }
+
+    return true;
+}
+
+UInt32 VoodooI2CHIDTouchPredictor::predictAxis(axis_state& state, UInt16 gain, UInt32 maximum) {
+    SInt64 horizon_ns = static_cast<SInt64>(interval_ms) * 1000000LL;
+
+    // p + v·t + a·t²/2
+    SInt64 offset = (state.velocity * horizon_ns) / NSEC_PER_SEC_S64;
+    offset += (((state.acceleration * horizon_ns) / NSEC_PER_SEC_S64) * horizon_ns) / (2 * NSEC_PER_SEC_S64);
+    offset = (offset * gain) >> 8;
+
+    SInt64 predicted = state.position + offset;
+
+    if (predicted < 0)
+        predicted = 0;
+    if (maximum && predicted > maximum)
+        predicted = maximum;
+
+    return static_cast<UInt32>(predicted);
+}
+
+void VoodooI2CHIDTouchPredictor::reset() {
+    memset(contacts, 0, sizeof(contacts));
+}
+
+bool VoodooI2CHIDTouchPredictor::updateAxis(axis_state& state, SInt64 position, SInt64 interval_ns) {
+    SInt64 velocity = ((position - state.position) * NSEC_PER_SEC_S64) / interval_ns;
+
+    // Lightly smooth the velocity, finite differences of touch samples are noisy
+    velocity = clamp((state.velocity + 3 * velocity) / 4, MAX_VELOCITY);
+
+    SInt64 acceleration = ((velocity - state.velocity) * NSEC_PER_SEC_S64) / interval_ns;
+    state.acceleration = clamp((3 * state.acceleration + acceleration) / 4, MAX_ACCELERATION);
+
+    bool reversed = (velocity > 0 && state.velocity < 0) || (velocity < 0 && state.velocity > 0);
+
+    state.velocity = velocity;
+    state.position = position;
+
+    return reversed;
+}
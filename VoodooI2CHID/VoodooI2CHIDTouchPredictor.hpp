@@ -0,0 +1,85 @@
+//
+//  VoodooI2CHIDTouchPredictor.hpp
+//  VoodooI2CHID
+//
+//  Created by agent on 19/10/2026.
+//  Copyright © 2026 Alexandre Daoud. All rights reserved.
+//
+
+#ifndef VoodooI2CHIDTouchPredictor_hpp
+#define VoodooI2CHIDTouchPredictor_hpp
+
+#include "VoodooI2CHIDInputPipeline.hpp"
+
+#include "../../../Multitouch Support/VoodooI2CDigitiserTransducer.hpp"
+
+#define TOUCH_PREDICTOR_MAX_CONTACTS     16
+#define TOUCH_PREDICTOR_DEFAULT_INTERVAL 20     // ms
+#define TOUCH_PREDICTOR_MAX_INTERVAL     50     // ms
+#define TOUCH_PREDICTOR_MAX_SAMPLE_NS    100000000ULL
+#define TOUCH_PREDICTOR_FULL_GAIN        256
+#define TOUCH_PREDICTOR_GAIN_RECOVERY    64
+
+/* Extrapolates finger positions ahead of time to hide scan, bus and scheduling latency
+ *
+ * The velocity and acceleration of every contact are estimated from consecutive samples using the frame timestamp, which
+ * is the device scan time whenever the digitiser reports one. The position reported to the multitouch interface is then
+ * moved <interval_ms> ahead along that trajectory. The prediction gain drops to zero whenever the contact reverses
+ * direction on an axis that carries a fair share of its motion and recovers over the following frames, so that overshoot
+ * on direction changes is damped.
+ */
+
+class VoodooI2CHIDTouchPredictor : public VoodooI2CHIDInputStage {
+ public:
+    bool enabled = false;
+    UInt32 interval_ms = TOUCH_PREDICTOR_DEFAULT_INTERVAL;
+
+    const char* getStageName() const { return "Prediction"; }
+
+    bool processFrame(VoodooI2CHIDInputFrame& frame);
+
+    /* Forgets every contact */
+
+    void reset();
+
+ private:
+    struct axis_state {
+        SInt64 position;
+        SInt64 velocity;        // Logical units per second
+        SInt64 acceleration;    // Logical units per second squared
+    };
+
+    struct contact_state {
+        UInt8 samples;
+        UInt16 gain;            // 8.8 fixed point
+        UInt32 identifier;
+        uint64_t timestamp;
+        axis_state x;
+        axis_state y;
+    };
+
+    contact_state contacts[TOUCH_PREDICTOR_MAX_CONTACTS] = {};
+
+    /* Updates the motion estimate of an axis with a new sample
+     * @state The state of the axis
+     * @position The new position
+     * @interval_ns The time since the previous sample
+     *
+     * @return *true* if the axis changed direction, *false* otherwise
+     */
+
+    bool updateAxis(axis_state& state, SInt64 position, SInt64 interval_ns);
+
+    /* Extrapolates an axis
+     * @state The state of the axis
+     * @gain The prediction gain in 8.8 fixed point
+     * @maximum The logical maximum of the axis
+     *
+     * @return The predicted position
+     */
+
+    UInt32 predictAxis(axis_state& state, UInt16 gain, UInt32 maximum);
+};
+
+
+#endif /* VoodooI2CHIDTouchPredictor_hpp */
@@ -21,15 +21,6 @@
 #define super IOHIDEventService
 OSDefineMetaClassAndStructors(VoodooI2CMultitouchHIDEventDriver, IOHIDEventService);
 
-static int pow(int x, int y) {
-    int ret = 1;
-    while (y > 0) {
-        ret *= x;
-        y--;
-    }
-    return ret;
-}
-
 static int roundUp(int numToRound, int multiple) {
     if (multiple == 0)
         return numToRound;
@@ -41,6 +32,25 @@ static int roundUp(int numToRound, int multiple) {
     return numToRound + multiple - remainder;
 }
 
+bool VoodooI2CMultitouchHIDEventDriver::acquireFrame(VoodooI2CHIDInputFrame& frame) {
+    // Touchpad is disabled through ApplePS2Keyboard request
+    if (ignore_all)
+        return false;
+
+    // Reports from other top level collections (e.g. the mouse collection of a composite device) are of no use to us
+    if (i2c_hid_device && !i2c_hid_device->isReportRouted(this, frame.report_id))
+        return false;
+
+    // Ignore touchpad interaction(s) shortly after typing, unless palm rejection only ignores the keyboard zone
+    if (!palm_rejection.typing_zone && frame.timestamp < palm_rejection.typing_until)
+        return false;
+
+    if (!readyForReports() || frame.report_type != kIOHIDReportTypeInput)
+        return false;
+
+    return true;
+}
+
 void VoodooI2CMultitouchHIDEventDriver::calibrateJustifiedPreferredStateElement(IOHIDElement* element, SInt32 removal_percentage) {
     UInt32 sat_min   = element->getLogicalMin();
     UInt32 sat_max   = element->getLogicalMax();
@@ -59,9 +69,118 @@ bool VoodooI2CMultitouchHIDEventDriver::didTerminate(IOService* provider, IOOpti
     return super::didTerminate(provider, options, defer);
 }
 
+void VoodooI2CMultitouchHIDEventDriver::flushFrame(AbsoluteTime timestamp) {
+    if (frame_timer)
+        frame_timer->cancelTimeout();
+
+    if (frame_assembler.getReceivedContactCount()) {
+        VoodooI2CHIDInputFrame frame;
+        frame.timestamp = timestamp;
+        frame.report = NULL;
+        frame.report_type = kIOHIDReportTypeInput;
+        frame.report_id = 0;
+        frame.event.contact_count = frame_assembler.getReceivedContactCount();
+        frame.event.transducers = digitiser.transducers;
+
+        // The frame has already been acquired and decoded
+        input_pipeline.run(frame, kVoodooI2CHIDInputPhaseFilter);
+    }
+
+    frame_assembler.finishFrame();
+}
+
 void VoodooI2CMultitouchHIDEventDriver::forwardReport(VoodooI2CMultitouchEvent event, AbsoluteTime timestamp) {
-    if (multitouch_interface)
-        multitouch_interface->handleInterruptReport(event, timestamp);
+    if (!multitouch_interface)
+        return;
+
+    // Resting fingers produce a stream of identical frames, the gesture engines only need to see them once in a while
+    if (!frame_filter.shouldForward(event, timestamp))
+        return;
+
+    multitouch_interface->handleInterruptReport(event, timestamp);
+}
+
+void VoodooI2CMultitouchHIDEventDriver::frameAssemblyTimeout(OSObject* owner, IOTimerEventSource* timer) {
+    if (!frame_assembler.isPending())
+        return;
+
+    frame_assembler.incomplete_frames++;
+
+    flushFrame(digitiser.frame_timestamp);
+}
+
+bool VoodooI2CMultitouchHIDEventDriver::decodeFrame(VoodooI2CHIDInputFrame& frame) {
+    UInt8 contact_count = digitiser.contact_count ? digitiser.contact_count->getValue() : 0;
+
+    if (contact_count) {
+        // A new frame has started before the previous one was complete, deliver what we have so far
+        if (frame_assembler.isPending()) {
+            frame_assembler.recovered_frames++;
+            flushFrame(digitiser.frame_timestamp);
+        }
+
+        digitiser.current_contact_count = contact_count;
+        frame_assembler.beginFrame(frame.timestamp, contact_count);
+    } else if (!frame_assembler.isPending()) {
+        // In hybrid mode only the first report of a frame carries the contact count, a report without one outside of a
+        // frame is how several panels report the last lift so it is delivered on its own
+        if (frame_assembler.isHybrid()) {
+            frame_assembler.orphaned_reports++;
+            frame_assembler.beginFrame(frame.timestamp, 0);
+        } else {
+            frame_assembler.beginFrame(frame.timestamp, digitiser.current_contact_count);
+        }
+    }
+
+    // Stamp every report of a frame with the time the digitiser scanned it rather than with its arrival time
+    if (!frame_assembler.getCurrentReport()) {
+        digitiser.frame_timestamp = frame.timestamp;
+
+        if (digitiser.scan_time) {
+            digitiser.frame_timestamp = scan_time_clock.convert(digitiser.scan_time->getValue(), frame.timestamp);
+
+            if (scan_time_clock.measurements != published_clock_measurements)
+                publishScanTimeStatistics();
+        }
+    }
+
+    frame.timestamp = digitiser.frame_timestamp;
+
+    digitiser.current_report = frame_assembler.getCurrentReport() + 1;
+
+    handleDigitizerReport(frame.timestamp, frame.report_id);
+
+    frame_assembler.endReport();
+
+    if (!frame_assembler.isComplete()) {
+        if (frame_timer && frame_assembler.getCurrentReport() == 1)
+            frame_timer->setTimeoutUS(frame_assembler.getTimeoutUS());
+
+        return false;
+    }
+
+    if (frame_timer)
+        frame_timer->cancelTimeout();
+
+    frame.event.contact_count = digitiser.current_contact_count;
+
+    frame_assembler.finishFrame();
+
+    return true;
+}
+
+bool VoodooI2CMultitouchHIDEventDriver::dispatchFrame(VoodooI2CHIDInputFrame& frame) {
+    // The next frame is already waiting and will carry the latest positions, only changes in the contact set must not be skipped
+    if (collapse_backlog && i2c_hid_device && i2c_hid_device->isInputPending() && !hasContactTransition(frame.event)) {
+        collapsed_frames++;
+        return false;
+    }
+
+    forwardReport(frame.event, frame.timestamp);
+
+    dispatched_contact_count = frame.event.contact_count;
+
+    return true;
 }
 
 UInt32 VoodooI2CMultitouchHIDEventDriver::getElementValue(IOHIDElement* element) {
@@ -76,8 +195,6 @@ UInt32 VoodooI2CMultitouchHIDEventDriver::getElementValue(IOHIDElement* element)
 }
 
 const char* VoodooI2CMultitouchHIDEventDriver::getProductName() {
-    VoodooI2CHIDDevice* i2c_hid_device = OSDynamicCast(VoodooI2CHIDDevice, hid_device);
-
     if (i2c_hid_device)
         return i2c_hid_device->name;
 
@@ -88,45 +205,24 @@ const char* VoodooI2CMultitouchHIDEventDriver::getProductName() {
 }
 
 void VoodooI2CMultitouchHIDEventDriver::handleInterruptReport(AbsoluteTime timestamp, IOMemoryDescriptor* report, IOHIDReportType report_type, UInt32 report_id) {
-    // Touchpad is disabled through ApplePS2Keyboard request
-    if (ignore_all)
-        return;
-    
-    uint64_t now_abs;
-    clock_get_uptime(&now_abs);
-    uint64_t now_ns;
-    absolutetime_to_nanoseconds(now_abs, &now_ns);
-    
-    // Ignore touchpad interaction(s) shortly after typing
-    if (now_ns - key_time < max_after_typing)
-        return;
-    
-    if (!readyForReports() || report_type != kIOHIDReportTypeInput)
-        return;
-
-    if (digitiser.contact_count && digitiser.contact_count->getValue()) {
-        digitiser.current_contact_count = digitiser.contact_count->getValue();
-        
-        UInt8 finger_count = digitiser.fingers->getCount();
-        
-        digitiser.report_count = static_cast<int>(roundUp(digitiser.current_contact_count, finger_count)/finger_count);
-        digitiser.current_report = 1;
-    }
-
-    handleDigitizerReport(timestamp, report_id);
+    VoodooI2CHIDInputFrame frame;
+    frame.timestamp = timestamp;
+    frame.report = report;
+    frame.report_type = report_type;
+    frame.report_id = report_id;
+    frame.event.contact_count = 0;
+    frame.event.transducers = digitiser.transducers;
+
+    // Reports arrive on the read thread of the device, the timers of this driver and its subclasses fire on our work
+    // loop. Decoding under its gate is what keeps them apart, reports that arrive before the gate exists are dropped.
+    if (command_gate)
+        command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CMultitouchHIDEventDriver::handleInterruptReportGated), &frame);
+}
 
-    if (digitiser.current_report == digitiser.report_count) {
-        VoodooI2CMultitouchEvent event;
-        event.contact_count = digitiser.current_contact_count;
-        event.transducers = digitiser.transducers;
+IOReturn VoodooI2CMultitouchHIDEventDriver::handleInterruptReportGated(VoodooI2CHIDInputFrame* frame) {
+    input_pipeline.run(*frame);
 
-        forwardReport(event, timestamp);
-        
-        digitiser.report_count = 1;
-        digitiser.current_report = 1;
-    } else {
-        digitiser.current_report++;
-    }
+    return kIOReturnSuccess;
 }
 
 void VoodooI2CMultitouchHIDEventDriver::handleDigitizerReport(AbsoluteTime timestamp, UInt32 report_id) {
@@ -163,6 +259,9 @@ void VoodooI2CMultitouchHIDEventDriver::handleDigitizerReport(AbsoluteTime times
     for (int i = 0; i < wrapper->transducers->getCount(); i++) {
         VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, wrapper->transducers->getObject(i));
         handleDigitizerTransducerReport(transducer, timestamp, report_id);
+
+        if (transducer->type == kDigitiserTransducerFinger)
+            frame_assembler.addContact(transducer->secondary_id);
     }
     
     // Now handle button report
@@ -365,6 +464,18 @@ bool VoodooI2CMultitouchHIDEventDriver::handleStart(IOService* provider) {
         return false;
     }
     
+    acquire_stage.bind(this, &VoodooI2CMultitouchHIDEventDriver::acquireFrame, "Acquire");
+    decode_stage.bind(this, &VoodooI2CMultitouchHIDEventDriver::decodeFrame, "Decode");
+    dispatch_stage.bind(this, &VoodooI2CMultitouchHIDEventDriver::dispatchFrame, "Dispatch");
+
+    input_pipeline.addStage(&acquire_stage, kVoodooI2CHIDInputPhaseAcquire);
+    input_pipeline.addStage(&decode_stage, kVoodooI2CHIDInputPhaseDecode);
+    input_pipeline.addStage(&palm_rejection, kVoodooI2CHIDInputPhaseFilter);
+    input_pipeline.addStage(&smoothing_filter, kVoodooI2CHIDInputPhaseFilter);
+    input_pipeline.addStage(&contact_tracker, kVoodooI2CHIDInputPhaseTrack);
+    input_pipeline.addStage(&touch_predictor, kVoodooI2CHIDInputPhaseTrack);
+    input_pipeline.addStage(&dispatch_stage, kVoodooI2CHIDInputPhaseDispatch);
+
     hid_interface = OSDynamicCast(IOHIDInterface, provider);
 
     if (!hid_interface)
@@ -384,6 +495,14 @@ bool VoodooI2CMultitouchHIDEventDriver::handleStart(IOService* provider) {
     
     if (!hid_device)
         return false;
+
+    i2c_hid_device = OSDynamicCast(VoodooI2CHIDDevice, hid_device);
+
+    // Start measuring wakeups from the moment we take over the device
+    clock_get_uptime(&digitiser_state_start);
+
+    if (i2c_hid_device)
+        digitiser_state_interrupts = i2c_hid_device->getInterruptCount();
     
     name = getProductName();
 
@@ -419,8 +538,11 @@ bool VoodooI2CMultitouchHIDEventDriver::handleStart(IOService* provider) {
         IOLog("%s::%s Could not parse multitouch elements\n", getName(), name);
         return false;
     }
+
+    registerReportRoutes();
     
     setDigitizerProperties();
+    publishFrameAssemblerStatistics();
 
     PMinit();
     hid_interface->joinPMtree(this);
@@ -430,6 +552,11 @@ bool VoodooI2CMultitouchHIDEventDriver::handleStart(IOService* provider) {
 }
 
 void VoodooI2CMultitouchHIDEventDriver::handleStop(IOService* provider) {
+    if (i2c_hid_device) {
+        i2c_hid_device->removeReportRoutes(this);
+        i2c_hid_device = NULL;
+    }
+
     OSSafeReleaseNULL(digitiser.transducers);
     OSSafeReleaseNULL(digitiser.wrappers);
     OSSafeReleaseNULL(digitiser.styluses);
@@ -444,6 +571,12 @@ void VoodooI2CMultitouchHIDEventDriver::handleStop(IOService* provider) {
         OSSafeReleaseNULL(multitouch_interface);
     }
     
+    if (frame_timer) {
+        frame_timer->cancelTimeout();
+        work_loop->removeEventSource(frame_timer);
+        OSSafeReleaseNULL(frame_timer);
+    }
+
     if (command_gate) {
         work_loop->removeEventSource(command_gate);
         OSSafeReleaseNULL(command_gate);
@@ -455,6 +588,24 @@ void VoodooI2CMultitouchHIDEventDriver::handleStop(IOService* provider) {
     super::handleStop(provider);
 }
 
+bool VoodooI2CMultitouchHIDEventDriver::hasContactTransition(VoodooI2CMultitouchEvent& event) {
+    if (event.contact_count != dispatched_contact_count || !event.transducers)
+        return true;
+
+    for (int i = 0; i < event.transducers->getCount(); i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(i));
+
+        if (!transducer)
+            continue;
+
+        if (transducer->tip_switch.value() != transducer->tip_switch.last.value ||
+            transducer->physical_button.value() != transducer->physical_button.last.value)
+            return true;
+    }
+
+    return false;
+}
+
 IOReturn VoodooI2CMultitouchHIDEventDriver::parseDigitizerElement(IOHIDElement* digitiser_element) {
     OSArray* children = digitiser_element->getChildElements();
     
@@ -467,15 +618,26 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseDigitizerElement(IOHIDElement*
         for (int i = 0; i < children->getCount(); i++) {
             IOHIDElement* element = OSDynamicCast(IOHIDElement, children->getObject(i));
             
-            if (element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Finger)) {
-                OSArray* sub_array = element->getChildElements();
+            if (!element || !element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Finger))
+                continue;
 
-                for (int j = 0; j < sub_array->getCount(); j++) {
-                    IOHIDElement* sub_element = OSDynamicCast(IOHIDElement, sub_array->getObject(j));
+            OSArray* sub_array = element->getChildElements();
 
-                    if (sub_element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_DeviceMode))
-                        digitiser.input_mode = sub_element;
-                }
+            if (!sub_array)
+                continue;
+
+            for (int j = 0; j < sub_array->getCount(); j++) {
+                IOHIDElement* sub_element = OSDynamicCast(IOHIDElement, sub_array->getObject(j));
+
+                if (!sub_element)
+                    continue;
+
+                if (sub_element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_DeviceMode))
+                    digitiser.input_mode = sub_element;
+                else if (sub_element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Surface_Switch))
+                    digitiser.surface_switch = sub_element;
+                else if (sub_element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Button_Switch))
+                    digitiser.button_switch = sub_element;
             }
         }
         
@@ -484,6 +646,9 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseDigitizerElement(IOHIDElement*
 
     for (int i = 0; i < children->getCount(); i++) {
         IOHIDElement* element = OSDynamicCast(IOHIDElement, children->getObject(i));
+
+        if (!element)
+            continue;
         
         if (element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Stylus)) {
             digitiser.styluses->setObject(element);
@@ -495,57 +660,34 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseDigitizerElement(IOHIDElement*
             digitiser.fingers->setObject(element);
             
             // Let's grab the logical and physical min/max while we are here
-            // also the contact identifier
 
             OSArray* sub_array = element->getChildElements();
+
+            if (!sub_array || !multitouch_interface)
+                continue;
             
             for (int j = 0; j < sub_array->getCount(); j++) {
                 IOHIDElement* sub_element = OSDynamicCast(IOHIDElement, sub_array->getObject(j));
 
+                if (!sub_element)
+                    continue;
+
                 if (sub_element->conformsTo(kHIDPage_GenericDesktop, kHIDUsage_GD_X)) {
-                    if (multitouch_interface && !multitouch_interface->logical_max_x) {
+                    if (!multitouch_interface->logical_max_x) {
                         multitouch_interface->logical_max_x = sub_element->getLogicalMax();
-                        
-                        UInt32 raw_physical_max_x = sub_element->getPhysicalMax();
-                        
-                        UInt8 raw_unit_exponent = sub_element->getUnitExponent();
-                        if (raw_unit_exponent >> 3) {
-                            raw_unit_exponent = raw_unit_exponent | 0xf0; // Raise the 4-bit int to an 8-bit int
-                        }
-                        SInt8 unit_exponent = *(SInt8 *)&raw_unit_exponent;
-                        
-                        UInt32 physical_max_x = raw_physical_max_x;
-                        
-                        physical_max_x *= pow(10, (unit_exponent - -2));
-                        
-                        if (sub_element->getUnit() == 0x13) {
-                            physical_max_x *= 2.54;
-                        }
-
-                        multitouch_interface->physical_max_x = physical_max_x;
+                        multitouch_interface->physical_max_x = VoodooI2CHIDCoordinateTransform::scalePhysicalMax(sub_element->getPhysicalMax(), sub_element->getUnitExponent(), sub_element->getUnit());
                     }
                 } else if (sub_element->conformsTo(kHIDPage_GenericDesktop, kHIDUsage_GD_Y)) {
-                    if (multitouch_interface && !multitouch_interface->logical_max_y) {
+                    if (!multitouch_interface->logical_max_y) {
                         multitouch_interface->logical_max_y = sub_element->getLogicalMax();
-                        
-                        UInt32 raw_physical_max_y = sub_element->getPhysicalMax();
-                        
-                        UInt8 raw_unit_exponent = sub_element->getUnitExponent();
-                        if (raw_unit_exponent >> 3) {
-                            raw_unit_exponent = raw_unit_exponent | 0xf0; // Raise the 4-bit int to an 8-bit int
-                        }
-                        SInt8 unit_exponent = *(SInt8 *)&raw_unit_exponent;
-                        
-                        UInt32 physical_max_y = raw_physical_max_y;
-                        
-                        physical_max_y *= pow(10, (unit_exponent - -2));
-                        
-                        if (sub_element->getUnit() == 0x13) {
-                            physical_max_y *= 2.54;
-                        }
-                        
-                        multitouch_interface->physical_max_y = physical_max_y;
+                        multitouch_interface->physical_max_y = VoodooI2CHIDCoordinateTransform::scalePhysicalMax(sub_element->getPhysicalMax(), sub_element->getUnitExponent(), sub_element->getUnit());
                     }
+                } else if (sub_element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Width)) {
+                    if (!palm_rejection.logical_max_width)
+                        palm_rejection.logical_max_width = sub_element->getLogicalMax();
+                } else if (sub_element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Height)) {
+                    if (!palm_rejection.logical_max_height)
+                        palm_rejection.logical_max_height = sub_element->getLogicalMax();
                 }
             }
 
@@ -557,10 +699,21 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseDigitizerElement(IOHIDElement*
             continue;
         }
 
+        if (element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Scan_Time)) {
+            digitiser.scan_time = element;
+            continue;
+        }
+
         if (element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_DeviceMode)) {
             digitiser.input_mode = element;
             continue;
         }
+
+        // The Latency Mode feature lives in the touch pad collection rather than in the configuration collection
+        if (element->getType() == kIOHIDElementTypeFeature && element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_Latency_Mode)) {
+            digitiser.latency_mode = element;
+            continue;
+        }
     
         if (element->conformsTo(kHIDPage_Digitizer, kHIDUsage_Dig_ContactCountMaximum)) {
             digitiser.contact_count_maximum = element;
@@ -609,9 +762,15 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseElements() {
         return kIOReturnError;
 
     digitiser.wrappers = OSArray::withCapacity(1);
+
+    if (!digitiser.wrappers)
+        return kIOReturnNoResources;
+
+    UInt8 contact_count_maximum = 0;
     
-    if (digitiser.contact_count_maximum) {
-        UInt8 contact_count_maximum = getElementValue(digitiser.contact_count_maximum);
+    // A stylus-only digitiser may still declare a maximum contact count, there are no finger wrappers to build then
+    if (digitiser.contact_count_maximum && digitiser.fingers->getCount()) {
+        contact_count_maximum = getElementValue(digitiser.contact_count_maximum);
 
         // Check if maximum contact count divides by digitiser finger count
         if (contact_count_maximum % digitiser.fingers->getCount() != 0) {
@@ -624,7 +783,7 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseElements() {
             }
         }
 
-        int wrapper_count = static_cast<int>((1.0f * contact_count_maximum) / ( 1.0f * digitiser.fingers->getCount()));
+        int wrapper_count = contact_count_maximum / digitiser.fingers->getCount();
 
         for (int i = 0; i < wrapper_count; i++) {
             VoodooI2CHIDTransducerWrapper* wrapper = VoodooI2CHIDTransducerWrapper::wrapper();
@@ -638,6 +797,9 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseElements() {
                 IOHIDElement* finger = OSDynamicCast(IOHIDElement, digitiser.fingers->getObject(j));
             
                 VoodooI2CDigitiserTransducer* transducer = VoodooI2CDigitiserTransducer::transducer(kDigitiserTransducerFinger, finger);
+
+                if (!transducer)
+                    continue;
             
                 wrapper->transducers->setObject(transducer);
                 transducer->release();
@@ -645,9 +807,10 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseElements() {
             }
         
             VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, wrapper->transducers->getObject(0));
+            OSArray* child_elements = (transducer && transducer->collection) ? transducer->collection->getChildElements() : NULL;
         
-            for (int j = 0; j < transducer->collection->getChildElements()->getCount(); j++) {
-                IOHIDElement* element = OSDynamicCast(IOHIDElement, transducer->collection->getChildElements()->getObject(j));
+            for (int j = 0; child_elements && j < child_elements->getCount(); j++) {
+                IOHIDElement* element = OSDynamicCast(IOHIDElement, child_elements->getObject(j));
             
                 if (!element)
                     continue;
@@ -664,20 +827,180 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::parseElements() {
     
     if (digitiser.styluses->getCount()) {
         VoodooI2CHIDTransducerWrapper* stylus_wrapper = VoodooI2CHIDTransducerWrapper::wrapper();
+
+        if (!stylus_wrapper)
+            return kIOReturnNoResources;
+
         digitiser.wrappers->setObject(stylus_wrapper);
         
         IOHIDElement* stylus = OSDynamicCast(IOHIDElement, digitiser.styluses->getObject(0));
         VoodooI2CDigitiserStylus* transducer = VoodooI2CDigitiserStylus::stylus(kDigitiserTransducerStylus, stylus);
-        
-        stylus_wrapper->transducers->setObject(transducer);
-        transducer->release();
-        digitiser.transducers->setObject(0, transducer);
+
+        if (transducer) {
+            stylus_wrapper->transducers->setObject(transducer);
+            transducer->release();
+            digitiser.transducers->setObject(0, transducer);
+        }
+
         stylus_wrapper->release();
     }
 
+    // Let the frame assembler know how frames are laid out across reports
+    UInt8 contacts_per_report = digitiser.fingers->getCount();
+    bool has_identifiers = false;
+
+    if (contact_count_maximum && contacts_per_report) {
+        VoodooI2CHIDTransducerWrapper* wrapper = OSDynamicCast(VoodooI2CHIDTransducerWrapper, digitiser.wrappers->getObject(0));
+        has_identifiers = wrapper && wrapper->first_identifier;
+    }
+
+    frame_assembler.configure(contacts_per_report, contact_count_maximum, has_identifiers);
+
     return kIOReturnSuccess;
 }
 
+void VoodooI2CMultitouchHIDEventDriver::publishDigitiserDisableStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(4);
+
+    if (!properties)
+        return;
+
+    OSString* method = OSString::withCString(digitiser_disable_method);
+    properties->setObject("Method", method);
+    OSSafeReleaseNULL(method);
+
+    properties->setObject("Disabled", ignore_all ? kOSBooleanTrue : kOSBooleanFalse);
+
+    for (int i = 0; i < 2; i++) {
+        uint64_t time_ns;
+        absolutetime_to_nanoseconds(digitiser_state_time[i], &time_ns);
+
+        uint64_t rate = time_ns ? (digitiser_state_wakeups[i] * 1000000000ULL) / time_ns : 0;
+
+        OSNumber* number = OSNumber::withNumber(rate, 32);
+        properties->setObject(i ? "Disabled Wakeups Per Second" : "Enabled Wakeups Per Second", number);
+        OSSafeReleaseNULL(number);
+    }
+
+    setProperty("Digitiser Disable", properties);
+    properties->release();
+}
+
+void VoodooI2CMultitouchHIDEventDriver::publishFrameAssemblerStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(3);
+
+    if (!properties)
+        return;
+
+    OSNumber* number = OSNumber::withNumber(frame_assembler.incomplete_frames, 32);
+    properties->setObject("Incomplete Frames", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(frame_assembler.recovered_frames, 32);
+    properties->setObject("Recovered Frames", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(frame_assembler.orphaned_reports, 32);
+    properties->setObject("Orphaned Reports", number);
+    OSSafeReleaseNULL(number);
+
+    setProperty("Frame Assembler", properties);
+    properties->release();
+}
+
+void VoodooI2CMultitouchHIDEventDriver::publishFrameFilterStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(4);
+
+    if (!properties)
+        return;
+
+    properties->setObject("Enabled", frame_filter.enabled ? kOSBooleanTrue : kOSBooleanFalse);
+
+    OSNumber* number = OSNumber::withNumber(frame_filter.quantization_shift, 8);
+    properties->setObject("Quantization Shift", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(frame_filter.keep_alive_ms, 32);
+    properties->setObject("Keep Alive", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(frame_filter.suppressed_frames, 32);
+    properties->setObject("Suppressed Frames", number);
+    OSSafeReleaseNULL(number);
+
+    setProperty("Duplicate Frame Filter", properties);
+    properties->release();
+}
+
+void VoodooI2CMultitouchHIDEventDriver::publishInputPipelineStatistics() {
+    OSArray* statistics = input_pipeline.copyStatistics();
+
+    if (!statistics)
+        return;
+
+    OSDictionary* properties = OSDictionary::withCapacity(5);
+    OSDictionary* rejection = OSDictionary::withCapacity(5);
+    OSDictionary* tracking = OSDictionary::withCapacity(3);
+
+    if (rejection) {
+        OSNumber* number = OSNumber::withNumber(palm_rejection.low_confidence_contacts, 32);
+        rejection->setObject("Low Confidence Contacts", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(palm_rejection.oversized_contacts, 32);
+        rejection->setObject("Oversized Contacts", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(palm_rejection.edge_contacts, 32);
+        rejection->setObject("Edge Contacts", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(palm_rejection.typing_contacts, 32);
+        rejection->setObject("Typing Contacts", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(palm_rejection.stopped_frames, 32);
+        rejection->setObject("Stopped Frames", number);
+        OSSafeReleaseNULL(number);
+    }
+
+    if (tracking) {
+        OSNumber* number = OSNumber::withNumber(contact_tracker.new_contacts, 32);
+        tracking->setObject("New Contacts", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(contact_tracker.gated_contacts, 32);
+        tracking->setObject("Gated Contacts", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(contact_tracker.identifier_changes, 32);
+        tracking->setObject("Identifier Changes", number);
+        OSSafeReleaseNULL(number);
+    }
+
+    if (properties) {
+        properties->setObject("Timing", input_pipeline.timing ? kOSBooleanTrue : kOSBooleanFalse);
+        properties->setObject("Stages", statistics);
+
+        OSNumber* number = OSNumber::withNumber(collapsed_frames, 32);
+        properties->setObject("Collapsed Frames", number);
+        OSSafeReleaseNULL(number);
+
+        if (rejection && (palm_rejection.enabled || palm_rejection.typing_zone))
+            properties->setObject("Palm Rejection", rejection);
+
+        if (tracking && contact_tracker.enabled)
+            properties->setObject("Contact Tracking", tracking);
+
+        setProperty("Input Pipeline", properties);
+        properties->release();
+    }
+
+    OSSafeReleaseNULL(rejection);
+    OSSafeReleaseNULL(tracking);
+    statistics->release();
+}
+
 IOReturn VoodooI2CMultitouchHIDEventDriver::publishMultitouchInterface() {
     multitouch_interface = OSTypeAlloc(VoodooI2CMultitouchInterface);
 
@@ -705,6 +1028,87 @@ exit:
     return kIOReturnError;
 }
 
+void VoodooI2CMultitouchHIDEventDriver::publishScanTimeStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(4);
+
+    if (!properties)
+        return;
+
+    published_clock_measurements = scan_time_clock.measurements;
+
+    OSNumber* number = OSNumber::withNumber(static_cast<SInt64>(scan_time_clock.skew_ppm), 32);
+    properties->setObject("Clock Skew (ppm)", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(scan_time_clock.maximum_correction_us, 32);
+    properties->setObject("Maximum Correction (us)", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(scan_time_clock.measurements, 32);
+    properties->setObject("Measurements", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(scan_time_clock.resynchronisations, 32);
+    properties->setObject("Resynchronisations", number);
+    OSSafeReleaseNULL(number);
+
+    setProperty("Scan Time", properties);
+    properties->release();
+}
+
+IOReturn VoodooI2CMultitouchHIDEventDriver::setDeviceReporting(bool enabled) {
+    if (!i2c_hid_device)
+        return kIOReturnUnsupported;
+
+    IOReturn ret = i2c_hid_device->setReportingSuspended(!enabled);
+
+    if (ret == kIOReturnSuccess)
+        digitiser_disable_method = "HID Sleep";
+
+    return ret;
+}
+
+void VoodooI2CMultitouchHIDEventDriver::setDigitiserEnabled(bool enabled) {
+    if (command_gate)
+        command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CMultitouchHIDEventDriver::setDigitiserEnabledGated), &enabled);
+}
+
+IOReturn VoodooI2CMultitouchHIDEventDriver::setDigitiserEnabledGated(bool* enabled) {
+    if (*enabled != ignore_all)
+        return kIOReturnSuccess;
+
+    // Close the period spent in the current state
+    uint64_t now;
+    clock_get_uptime(&now);
+
+    UInt32 interrupts = i2c_hid_device ? i2c_hid_device->getInterruptCount() : 0;
+
+    digitiser_state_time[ignore_all] += now - digitiser_state_start;
+    digitiser_state_wakeups[ignore_all] += interrupts - digitiser_state_interrupts;
+    digitiser_state_start = now;
+    digitiser_state_interrupts = interrupts;
+
+    if (*enabled) {
+        if (device_reporting_disabled)
+            setDeviceReporting(true);
+
+        device_reporting_disabled = false;
+        ignore_all = false;
+    } else {
+        // Drop whatever is still on its way before the device stops reporting
+        ignore_all = true;
+
+        device_reporting_disabled = (setDeviceReporting(false) == kIOReturnSuccess);
+
+        if (!device_reporting_disabled)
+            digitiser_disable_method = "Software";
+    }
+
+    publishDigitiserDisableStatistics();
+
+    return kIOReturnSuccess;
+}
+
 inline void VoodooI2CMultitouchHIDEventDriver::setButtonState(DigitiserTransducerButtonState* state, UInt32 bit, UInt32 value, AbsoluteTime timestamp) {
     UInt32 buttonMask = (1 << bit);
     
@@ -725,8 +1129,12 @@ void VoodooI2CMultitouchHIDEventDriver::setDigitizerProperties() {
 
     properties->setObject("Contact Count Element", digitiser.contact_count);
     properties->setObject("Input Mode Element", digitiser.input_mode);
+    properties->setObject("Latency Mode Element", digitiser.latency_mode);
     properties->setObject("Contact Count Maximum  Element", digitiser.contact_count_maximum);
     properties->setObject("Button Element", digitiser.button);
+    properties->setObject("Scan Time Element", digitiser.scan_time);
+    properties->setObject("Surface Switch Element", digitiser.surface_switch);
+    properties->setObject("Button Switch Element", digitiser.button_switch);
     properties->setObject("Transducer Count", OSNumber::withNumber(digitiser.transducers->getCount(), 32));
 
     setProperty("Digitizer", properties);
@@ -756,14 +1164,108 @@ bool VoodooI2CMultitouchHIDEventDriver::start(IOService* provider) {
     }
     work_loop->addEventSource(command_gate);
 
+    frame_timer = IOTimerEventSource::timerEventSource(this, OSMemberFunctionCast(IOTimerEventSource::Action, this, &VoodooI2CMultitouchHIDEventDriver::frameAssemblyTimeout));
+
+    if (!frame_timer || work_loop->addEventSource(frame_timer) != kIOReturnSuccess) {
+        IOLog("%s::Could not add frame timer to work loop\n", getName());
+        OSSafeReleaseNULL(frame_timer);
+    }
+
     attached_hid_pointer_devices = OSSet::withCapacity(1);
     registerHIDPointerNotifications();
 
-    // Read QuietTimeAfterTyping configuration value (if available)
+    // Read QuietTimeAfterTyping configuration values (if available)
     OSNumber* quietTimeAfterTyping = OSDynamicCast(OSNumber, getProperty("QuietTimeAfterTyping"));
     
     if (quietTimeAfterTyping != NULL)
-        max_after_typing = quietTimeAfterTyping->unsigned64BitValue() * 1000000;
+        setQuietTimeAfterTyping(quietTimeAfterTyping->unsigned32BitValue());
+    else
+        setQuietTimeAfterTyping(QUIET_TIME_AFTER_TYPING_DEFAULT);
+
+    OSNumber* quietTimeAfterTypingZone = OSDynamicCast(OSNumber, getProperty("QuietTimeAfterTypingZone"));
+
+    if (quietTimeAfterTypingZone != NULL && quietTimeAfterTypingZone->unsigned16BitValue() <= 1000)
+        palm_rejection.typing_zone = quietTimeAfterTypingZone->unsigned16BitValue();
+
+    // Read duplicate frame filter configuration values (if available)
+    OSBoolean* suppressDuplicateFrames = OSDynamicCast(OSBoolean, getProperty("SuppressDuplicateFrames"));
+
+    if (suppressDuplicateFrames != NULL)
+        frame_filter.enabled = suppressDuplicateFrames->isTrue();
+
+    OSNumber* duplicateFrameQuantization = OSDynamicCast(OSNumber, getProperty("DuplicateFrameQuantization"));
+
+    if (duplicateFrameQuantization != NULL && duplicateFrameQuantization->unsigned8BitValue() < 16)
+        frame_filter.quantization_shift = duplicateFrameQuantization->unsigned8BitValue();
+
+    OSNumber* duplicateFrameKeepAlive = OSDynamicCast(OSNumber, getProperty("DuplicateFrameKeepAlive"));
+
+    if (duplicateFrameKeepAlive != NULL)
+        frame_filter.keep_alive_ms = duplicateFrameKeepAlive->unsigned32BitValue();
+
+    publishFrameFilterStatistics();
+
+    // Read palm rejection configuration values (if available)
+    OSBoolean* palmRejection = OSDynamicCast(OSBoolean, getProperty("PalmRejection"));
+
+    if (palmRejection != NULL)
+        palm_rejection.enabled = palmRejection->isTrue();
+
+    OSNumber* palmRejectionMaxSize = OSDynamicCast(OSNumber, getProperty("PalmRejectionMaxSize"));
+
+    if (palmRejectionMaxSize != NULL && palmRejectionMaxSize->unsigned16BitValue() <= 1000)
+        palm_rejection.max_size = palmRejectionMaxSize->unsigned16BitValue();
+
+    OSNumber* palmRejectionEdgeZone = OSDynamicCast(OSNumber, getProperty("PalmRejectionEdgeZone"));
+
+    if (palmRejectionEdgeZone != NULL && palmRejectionEdgeZone->unsigned16BitValue() < 500)
+        palm_rejection.edge_zone = palmRejectionEdgeZone->unsigned16BitValue();
+
+    OSNumber* palmRejectionTopZone = OSDynamicCast(OSNumber, getProperty("PalmRejectionTopZone"));
+
+    if (palmRejectionTopZone != NULL && palmRejectionTopZone->unsigned16BitValue() <= 1000)
+        palm_rejection.top_zone = palmRejectionTopZone->unsigned16BitValue();
+
+    // Read touch smoothing configuration values (if available)
+    OSBoolean* touchSmoothing = OSDynamicCast(OSBoolean, getProperty("TouchSmoothing"));
+
+    if (touchSmoothing != NULL)
+        smoothing_filter.enabled = touchSmoothing->isTrue();
+
+    OSNumber* touchSmoothingMinCutoff = OSDynamicCast(OSNumber, getProperty("TouchSmoothingMinCutoff"));
+    OSNumber* touchSmoothingBeta = OSDynamicCast(OSNumber, getProperty("TouchSmoothingBeta"));
+    OSNumber* touchSmoothingDerivativeCutoff = OSDynamicCast(OSNumber, getProperty("TouchSmoothingDerivativeCutoff"));
+
+    smoothing_filter.configure(touchSmoothingMinCutoff ? touchSmoothingMinCutoff->unsigned32BitValue() : SMOOTHING_FILTER_DEFAULT_MIN_CUTOFF,
+                               touchSmoothingBeta ? touchSmoothingBeta->unsigned32BitValue() : SMOOTHING_FILTER_DEFAULT_BETA,
+                               touchSmoothingDerivativeCutoff ? touchSmoothingDerivativeCutoff->unsigned32BitValue() : SMOOTHING_FILTER_DEFAULT_DERIVATIVE_CUTOFF);
+
+    // Read CollapseFrameBacklog configuration value (if available)
+    OSBoolean* collapseFrameBacklog = OSDynamicCast(OSBoolean, getProperty("CollapseFrameBacklog"));
+
+    if (collapseFrameBacklog != NULL)
+        collapse_backlog = collapseFrameBacklog->isTrue();
+
+    // Read contact tracking configuration values (if available)
+    OSBoolean* contactTracking = OSDynamicCast(OSBoolean, getProperty("ContactTracking"));
+
+    if (contactTracking != NULL)
+        contact_tracker.enabled = contactTracking->isTrue();
+
+    OSNumber* contactTrackingGate = OSDynamicCast(OSNumber, getProperty("ContactTrackingGate"));
+
+    contact_tracker.configure(frame_assembler.getMaximumContacts(), contactTrackingGate ? contactTrackingGate->unsigned32BitValue() : 0);
+
+    // Read touch prediction configuration values (if available)
+    OSBoolean* touchPrediction = OSDynamicCast(OSBoolean, getProperty("TouchPrediction"));
+
+    if (touchPrediction != NULL)
+        touch_predictor.enabled = touchPrediction->isTrue();
+
+    OSNumber* touchPredictionInterval = OSDynamicCast(OSNumber, getProperty("TouchPredictionInterval"));
+
+    if (touchPredictionInterval != NULL && touchPredictionInterval->unsigned32BitValue() <= TOUCH_PREDICTOR_MAX_INTERVAL)
+        touch_predictor.interval_ms = touchPredictionInterval->unsigned32BitValue();
 
     setProperty("VoodooI2CServices Supported", kOSBooleanTrue);
 
@@ -790,16 +1292,18 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::message(UInt32 type, IOService* prov
             // ignore_all is true when trackpad has been disabled
             if (enable == ignore_all) {
                 // save state, and update LED
-                ignore_all = !enable;
+                setDigitiserEnabled(enable);
             }
             break;
         }
         case kKeyboardKeyPressTime:
         {
-            //  Remember last time key was pressed
-            key_time = *((uint64_t*)argument);
+            //  Remember last time key was pressed, ApplePS2Keyboard sends it in nanoseconds
+            uint64_t key_time_ns = *((uint64_t*)argument);
+            nanoseconds_to_absolutetime(key_time_ns, &key_time);
+            palm_rejection.typing_until = key_time + quiet_time_after_typing;
 #if DEBUG
-            IOLog("%s::keyPressed = %llu\n", getName(), key_time);
+            IOLog("%s::keyPressed = %llu\n", getName(), key_time_ns);
 #endif
             break;
         }
@@ -808,6 +1312,13 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::message(UInt32 type, IOService* prov
     return kIOReturnSuccess;
 }
 
+void VoodooI2CMultitouchHIDEventDriver::setQuietTimeAfterTyping(UInt32 quiet_time_ms) {
+    nanoseconds_to_absolutetime(quiet_time_ms * 1000000ULL, &quiet_time_after_typing);
+
+    if (key_time)
+        palm_rejection.typing_until = key_time + quiet_time_after_typing;
+}
+
 IOReturn VoodooI2CMultitouchHIDEventDriver::setProperties(OSObject * properties) {
     // Listen for property changes we are interested in (instead of reading these during frequent IO events)
     OSDictionary* dict = OSDynamicCast(OSDictionary, properties);
@@ -827,9 +1338,33 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::setProperties(OSObject * properties)
                         
                         // If there are devices connected and automatically switch the current ignore status on/off
                         if (attached_hid_pointer_devices->getCount() > 0) {
-                            ignore_all = ignore_mouse;
+                            setDigitiserEnabled(!ignore_mouse);
                         }
                     }
+                } else if (key->isEqualTo("CollapseFrameBacklog")) {
+                    OSBoolean* value = OSDynamicCast(OSBoolean, dict->getObject(key));
+
+                    if (value != NULL) {
+                        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), value->isTrue());
+
+                        collapse_backlog = value->isTrue();
+                    }
+                } else if (key->isEqualTo("QuietTimeAfterTyping")) {
+                    OSNumber* value = OSDynamicCast(OSNumber, dict->getObject(key));
+
+                    if (value != NULL) {
+                        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), value->unsigned32BitValue());
+
+                        setQuietTimeAfterTyping(value->unsigned32BitValue());
+                    }
+                } else if (key->isEqualTo("UpdateInputPipelineStatistics")) {
+                    publishInputPipelineStatistics();
+                } else if (key->isEqualTo("UpdateFrameAssemblerStatistics")) {
+                    publishFrameAssemblerStatistics();
+                } else if (key->isEqualTo("UpdateFrameFilterStatistics")) {
+                    publishFrameFilterStatistics();
+                } else {
+                    setPipelineProperty(key, dict->getObject(key));
                 }
             }
 
@@ -840,6 +1375,121 @@ IOReturn VoodooI2CMultitouchHIDEventDriver::setProperties(OSObject * properties)
     return super::setProperties(properties);
 }
 
+void VoodooI2CMultitouchHIDEventDriver::setPipelineProperty(const OSSymbol* key, OSObject* value) {
+    if (!command_gate) {
+        setPipelinePropertyGated(key, value);
+        return;
+    }
+
+    command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CMultitouchHIDEventDriver::setPipelinePropertyGated), const_cast<OSSymbol*>(key), value);
+}
+
+IOReturn VoodooI2CMultitouchHIDEventDriver::setPipelinePropertyGated(const OSSymbol* key, OSObject* value) {
+    if (key->isEqualTo("InputPipelineTiming")) {
+        OSBoolean* timing = OSDynamicCast(OSBoolean, value);
+
+        if (timing == NULL)
+            return kIOReturnBadArgument;
+
+        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), timing->isTrue());
+
+        // Start every measurement from a clean slate, the results are published once timing is turned off
+        if (timing->isTrue() && !input_pipeline.timing)
+            input_pipeline.resetStatistics();
+
+        input_pipeline.timing = timing->isTrue();
+        publishInputPipelineStatistics();
+
+        return kIOReturnSuccess;
+    }
+
+    if (key->isEqualTo("PalmRejection")) {
+        OSBoolean* enabled = OSDynamicCast(OSBoolean, value);
+
+        if (enabled == NULL)
+            return kIOReturnBadArgument;
+
+        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), enabled->isTrue());
+
+        palm_rejection.reset();
+        palm_rejection.enabled = enabled->isTrue();
+
+        return kIOReturnSuccess;
+    }
+
+    if (key->isEqualTo("QuietTimeAfterTypingZone")) {
+        OSNumber* zone = OSDynamicCast(OSNumber, value);
+
+        if (zone == NULL || zone->unsigned16BitValue() > 1000)
+            return kIOReturnBadArgument;
+
+        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), zone->unsigned16BitValue());
+
+        palm_rejection.reset();
+        palm_rejection.typing_zone = zone->unsigned16BitValue();
+
+        return kIOReturnSuccess;
+    }
+
+    if (key->isEqualTo("SuppressDuplicateFrames")) {
+        OSBoolean* enabled = OSDynamicCast(OSBoolean, value);
+
+        if (enabled == NULL)
+            return kIOReturnBadArgument;
+
+        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), enabled->isTrue());
+
+        frame_filter.enabled = enabled->isTrue();
+        frame_filter.reset();
+        publishFrameFilterStatistics();
+
+        return kIOReturnSuccess;
+    }
+
+    if (key->isEqualTo("ContactTracking")) {
+        OSBoolean* enabled = OSDynamicCast(OSBoolean, value);
+
+        if (enabled == NULL)
+            return kIOReturnBadArgument;
+
+        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), enabled->isTrue());
+
+        contact_tracker.reset();
+        contact_tracker.enabled = enabled->isTrue();
+
+        return kIOReturnSuccess;
+    }
+
+    if (key->isEqualTo("TouchPrediction")) {
+        OSBoolean* enabled = OSDynamicCast(OSBoolean, value);
+
+        if (enabled == NULL)
+            return kIOReturnBadArgument;
+
+        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), enabled->isTrue());
+
+        touch_predictor.reset();
+        touch_predictor.enabled = enabled->isTrue();
+
+        return kIOReturnSuccess;
+    }
+
+    if (key->isEqualTo("TouchPredictionInterval")) {
+        OSNumber* interval = OSDynamicCast(OSNumber, value);
+
+        if (interval == NULL || interval->unsigned32BitValue() > TOUCH_PREDICTOR_MAX_INTERVAL)
+            return kIOReturnBadArgument;
+
+        IOLog("%s::setProperties %s = %d\n", getName(), key->getCStringNoCopy(), interval->unsigned32BitValue());
+
+        touch_predictor.interval_ms = interval->unsigned32BitValue();
+
+        return kIOReturnSuccess;
+    }
+
+    return kIOReturnUnsupported;
+}
+
 void VoodooI2CMultitouchHIDEventDriver::registerHIDPointerNotifications() {
     IOServiceMatchingNotificationHandler notificationHandler = OSMemberFunctionCast(IOServiceMatchingNotificationHandler, this, &VoodooI2CMultitouchHIDEventDriver::notificationHIDAttachedHandler);
     
@@ -875,6 +1525,47 @@ void VoodooI2CMultitouchHIDEventDriver::registerHIDPointerNotifications() {
     }
 }
 
+void VoodooI2CMultitouchHIDEventDriver::registerReportRoutes() {
+    if (!i2c_hid_device || !digitiser.transducers)
+        return;
+
+    UInt32 registered[I2C_HID_REPORT_ID_COUNT / 32] = {};
+    OSArray* elements = OSArray::withCapacity(8);
+
+    if (!elements)
+        return;
+
+    for (int i = 0; i < digitiser.transducers->getCount(); i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, digitiser.transducers->getObject(i));
+
+        if (transducer && transducer->collection && transducer->collection->getChildElements())
+            elements->merge(transducer->collection->getChildElements());
+    }
+
+    if (digitiser.contact_count)
+        elements->setObject(digitiser.contact_count);
+
+    if (digitiser.button)
+        elements->setObject(digitiser.button);
+
+    for (int i = 0; i < elements->getCount(); i++) {
+        IOHIDElement* element = OSDynamicCast(IOHIDElement, elements->getObject(i));
+
+        if (!element || element->getType() > kIOHIDElementTypeInput_ScanCodes)
+            continue;
+
+        UInt8 report_id = element->getReportID() & 0xFF;
+
+        if (registered[report_id / 32] & (1U << (report_id % 32)))
+            continue;
+
+        registered[report_id / 32] |= (1U << (report_id % 32));
+        i2c_hid_device->addReportRoute(this, report_id);
+    }
+
+    elements->release();
+}
+
 void VoodooI2CMultitouchHIDEventDriver::unregisterHIDPointerNotifications() {
     // Free device matching notifiers
     if (usb_hid_publish_notify) {
@@ -968,14 +1659,14 @@ void VoodooI2CMultitouchHIDEventDriver::notificationHIDAttachedHandlerGated(IOSe
     if (notifier == usb_hid_publish_notify || notifier == bluetooth_hid_publish_notify) {
         if (ignore_mouse && attached_hid_pointer_devices->getCount() > 0) {
             // One or more USB or Bluetooth pointer devices attached, disable trackpad
-            ignore_all = true;
+            setDigitiserEnabled(false);
         }
     }
     
     if (notifier == usb_hid_terminate_notify || notifier == bluetooth_hid_terminate_notify) {
         if (ignore_mouse && attached_hid_pointer_devices->getCount() == 0) {
             // No USB or bluetooth pointer devices attached, re-enable trackpad
-            ignore_all = false;
+            setDigitiserEnabled(true);
         }
     }
 }
@@ -19,6 +19,7 @@
 #include <IOKit/IOLib.h>
 #include <IOKit/IOKitKeys.h>
 #include <IOKit/IOService.h>
+#include <IOKit/IOTimerEventSource.h>
 
 #include <IOKit/hid/IOHIDEvent.h>
 #include <IOKit/hidevent/IOHIDEventService.h>
@@ -29,7 +30,16 @@
 #include <IOKit/hid/IOHIDDevice.h>
 
 
+#include "VoodooI2CHIDContactTracker.hpp"
+#include "VoodooI2CHIDCoordinateTransform.hpp"
 #include "VoodooI2CHIDDevice.hpp"
+#include "VoodooI2CHIDDuplicateFrameFilter.hpp"
+#include "VoodooI2CHIDFrameAssembler.hpp"
+#include "VoodooI2CHIDInputPipeline.hpp"
+#include "VoodooI2CHIDPalmRejectionFilter.hpp"
+#include "VoodooI2CHIDScanTimeClock.hpp"
+#include "VoodooI2CHIDSmoothingFilter.hpp"
+#include "VoodooI2CHIDTouchPredictor.hpp"
 #include "VoodooI2CHIDTransducerWrapper.hpp"
 
 #include "../../../Multitouch Support/VoodooI2CDigitiserStylus.hpp"
@@ -39,6 +49,12 @@
 #include "../../../Dependencies/helpers.hpp"
 
 #define kHIDUsage_Dig_Confidence kHIDUsage_Dig_TouchValid
+#define kHIDUsage_Dig_Scan_Time 0x56
+#define kHIDUsage_Dig_Surface_Switch 0x57
+#define kHIDUsage_Dig_Button_Switch 0x58
+#define kHIDUsage_Dig_Latency_Mode 0x60
+
+#define QUIET_TIME_AFTER_TYPING_DEFAULT 500     // ms
 
 // Message types defined by ApplePS2Keyboard
 enum {
@@ -68,7 +84,11 @@ class EXPORT VoodooI2CMultitouchHIDEventDriver : public IOHIDEventService {
         
         IOHIDElement*      contact_count;
         IOHIDElement*      input_mode;
+        IOHIDElement*      latency_mode;
         IOHIDElement*      button;
+        IOHIDElement*      scan_time;
+        IOHIDElement*      surface_switch;
+        IOHIDElement*      button_switch;
         
         // collection level elements
         
@@ -76,8 +96,9 @@ class EXPORT VoodooI2CMultitouchHIDEventDriver : public IOHIDEventService {
     
         
         UInt8              current_contact_count = 1;
-        UInt8              report_count = 1;
         UInt8              current_report = 1;
+
+        AbsoluteTime       frame_timestamp = 0;
     } digitiser;
 
     /* Calibrates an HID element
@@ -248,22 +269,65 @@ class EXPORT VoodooI2CMultitouchHIDEventDriver : public IOHIDEventService {
     bool awake = true;
     IOHIDInterface* hid_interface;
     IOHIDDevice* hid_device;
+    VoodooI2CHIDDevice* i2c_hid_device = NULL;
     VoodooI2CMultitouchInterface* multitouch_interface;
     bool should_have_interface = true;
 
+    VoodooI2CHIDFrameAssembler frame_assembler;
+    VoodooI2CHIDDuplicateFrameFilter frame_filter;
+    VoodooI2CHIDInputPipeline input_pipeline;
+
+    IOCommandGate* command_gate;
+
     virtual void forwardReport(VoodooI2CMultitouchEvent event, AbsoluteTime timestamp);
 
+    bool device_reporting_disabled = false;
+    const char* digitiser_disable_method = "Software";
+
+    /* Stops or resumes reporting at the device while the digitiser is disabled
+     * @enabled *true* to resume reporting, *false* to stop it
+     *
+     * The default implementation puts the I2C-HID device into HID sleep. Subclasses that know a less intrusive way to
+     * silence the digitiser should override this and set <digitiser_disable_method> on success.
+     *
+     * @return *kIOReturnSuccess* if the device changed its reporting, an error if reports must be dropped in software
+     */
+
+    virtual IOReturn setDeviceReporting(bool enabled);
+
  private:
     SInt32 absolute_axis_removal_percentage = 15;
     
     bool ignore_all;
     bool ignore_mouse = false;
 
-    uint64_t max_after_typing = 500000000;
-    uint64_t key_time = 0;
+    AbsoluteTime quiet_time_after_typing = 0;
+    AbsoluteTime key_time = 0;
+
+    UInt32 published_clock_measurements = 0;
+
+    AbsoluteTime digitiser_state_start = 0;
+    UInt32 digitiser_state_interrupts = 0;
+    AbsoluteTime digitiser_state_time[2] = {};      // Indexed by <ignore_all>
+    uint64_t digitiser_state_wakeups[2] = {};
+
+    bool collapse_backlog = false;
+    UInt32 collapsed_frames = 0;
+    UInt8 dispatched_contact_count = 0;
     
     IOWorkLoop* work_loop;
-    IOCommandGate* command_gate;
+    IOTimerEventSource* frame_timer;
+
+    VoodooI2CHIDMemberInputStage<VoodooI2CMultitouchHIDEventDriver> acquire_stage;
+    VoodooI2CHIDMemberInputStage<VoodooI2CMultitouchHIDEventDriver> decode_stage;
+    VoodooI2CHIDMemberInputStage<VoodooI2CMultitouchHIDEventDriver> dispatch_stage;
+
+    VoodooI2CHIDScanTimeClock scan_time_clock;
+
+    VoodooI2CHIDPalmRejectionFilter palm_rejection;
+    VoodooI2CHIDContactTracker contact_tracker;
+    VoodooI2CHIDSmoothingFilter smoothing_filter;
+    VoodooI2CHIDTouchPredictor touch_predictor;
     
     OSSet* attached_hid_pointer_devices;
     
@@ -273,6 +337,130 @@ class EXPORT VoodooI2CMultitouchHIDEventDriver : public IOHIDEventService {
     IONotifier* bluetooth_hid_publish_notify; // Notification when a bluetooth HID device is connected
     IONotifier* bluetooth_hid_terminate_notify; // Notification when a bluetooth HID device is disconnected
 
+    /* Input pipeline stage that drops reports while the digitiser is disabled, after typing or before we are ready
+     * @frame The frame being processed
+     *
+     * @return *true* if the report should be decoded, *false* otherwise
+     */
+
+    bool acquireFrame(VoodooI2CHIDInputFrame& frame);
+
+    /* Input pipeline stage that decodes a report into the transducers and assembles frames spanning several reports
+     * @frame The frame being processed
+     *
+     * @return *true* once the frame is complete, *false* while more reports are needed
+     */
+
+    bool decodeFrame(VoodooI2CHIDInputFrame& frame);
+
+    /* Input pipeline stage that forwards a complete frame to the multitouch interface
+     * @frame The frame being processed
+     *
+     * When *CollapseFrameBacklog* is set, frames that are already superseded by a pending report are skipped unless
+     * contacts touched down, lifted or changed button state.
+     *
+     * @return *true* if the frame was forwarded, *false* if it was collapsed into the next one
+     */
+
+    bool dispatchFrame(VoodooI2CHIDInputFrame& frame);
+
+    /* Checks whether a frame changes the contact set the multitouch interface saw last
+     * @event The frame to check
+     *
+     * @return *true* if contacts touched down, lifted or changed button state, *false* if they only moved
+     */
+
+    bool hasContactTransition(VoodooI2CMultitouchEvent& event);
+
+    /* Delivers whatever contacts have been assembled for the current frame and resets the frame assembler
+     * @timestamp The timestamp to deliver the frame with
+     */
+
+    void flushFrame(AbsoluteTime timestamp);
+
+    /* Called by the frame timer when the remaining reports of a hybrid mode frame did not arrive in time
+     * @owner The owner of the timer event source
+     * @timer The timer event source
+     */
+
+    void frameAssemblyTimeout(OSObject* owner, IOTimerEventSource* timer);
+
+    /* Runs a report through the input pipeline while holding the work loop, which serialises the decode with the frame
+     * timer and every other event source of the driver
+     * @frame The frame holding the report
+     */
+
+    IOReturn handleInterruptReportGated(VoodooI2CHIDInputFrame* frame);
+
+    /* Publishes how the digitiser is disabled and how often the device wakes us up in either state to the IOService plane
+     */
+
+    void publishDigitiserDisableStatistics();
+
+    /* Publishes the frame assembler counters to the IOService plane when UpdateFrameAssemblerStatistics is set, never
+     * from the report path
+     */
+
+    void publishFrameAssemblerStatistics();
+
+    /* Publishes the input pipeline stages and their timing statistics to the IOService plane
+     */
+
+    void publishInputPipelineStatistics();
+
+    /* Publishes the skew of the digitiser clock against host uptime to the IOService plane
+     */
+
+    void publishScanTimeStatistics();
+
+    /* Publishes the duplicate frame filter configuration and counters to the IOService plane, the counters are only
+     * refreshed when UpdateFrameFilterStatistics is set so that publishing stays off the report path
+     */
+
+    void publishFrameFilterStatistics();
+
+    /* Enables or disables the digitiser on behalf of the keyboard or because an external pointing device came and went
+     * @enabled *true* to enable the digitiser, *false* to disable it
+     */
+
+    void setDigitiserEnabled(bool enabled);
+
+    /* Gated half of <setDigitiserEnabled>
+     * @enabled Pointer to a boolean, *true* to enable the digitiser and *false* to disable it
+     */
+
+    IOReturn setDigitiserEnabledGated(bool* enabled);
+
+    /* Applies a property that changes the state of the input pipeline while holding the work loop, so that it never
+     * lands in the middle of a frame
+     * @key The property
+     * @value The new value
+     */
+
+    void setPipelineProperty(const OSSymbol* key, OSObject* value);
+
+    /* Gated half of <setPipelineProperty>
+     * @key The property
+     * @value The new value
+     *
+     * @return *kIOReturnSuccess* if the property was applied, *kIOReturnUnsupported* if it does not belong to the pipeline
+     */
+
+    IOReturn setPipelinePropertyGated(const OSSymbol* key, OSObject* value);
+
+    /* Sets how long after a key press the digitiser stays quiet
+     * @quiet_time_ms The quiet time in milliseconds
+     *
+     * The quiet time is kept in absolute time so that the per-report check is a single comparison.
+     */
+
+    void setQuietTimeAfterTyping(UInt32 quiet_time_ms);
+
+    /* Tells the I2C-HID device which input report IDs carry the digitiser elements we have parsed
+     */
+
+    void registerReportRoutes();
+
     /*
      * Register for notifications of attached HID pointer devices (both USB and bluetooth)
      */
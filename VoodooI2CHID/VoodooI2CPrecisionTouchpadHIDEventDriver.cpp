@@ -32,6 +32,16 @@ void VoodooI2CPrecisionTouchpadHIDEventDriver::handleInterruptReport(AbsoluteTim
     if (!ready)
         return;
 
+    if (latency_timer) {
+        last_activity = timestamp;
+
+        // Leave high latency mode from the work loop, the read thread must not wait on the feature report
+        if (high_latency && !normal_latency_requested) {
+            normal_latency_requested = true;
+            latency_timer->setTimeoutUS(1);
+        }
+    }
+
     super::handleInterruptReport(timestamp, report, report_type, report_id);
 }
 
@@ -46,21 +56,209 @@ bool VoodooI2CPrecisionTouchpadHIDEventDriver::handleStart(IOService* provider)
 
     enterPrecisionTouchpadMode();
 
+    // Read latency mode configuration values (if available)
+    OSBoolean* latencyModeSwitching = OSDynamicCast(OSBoolean, getProperty("LatencyModeSwitching"));
+
+    if (latencyModeSwitching != NULL)
+        latency_switching = latencyModeSwitching->isTrue();
+
+    OSNumber* latencyModeIdleTimeout = OSDynamicCast(OSNumber, getProperty("LatencyModeIdleTimeout"));
+
+    if (latencyModeIdleTimeout != NULL && latencyModeIdleTimeout->unsigned32BitValue())
+        latency_idle_timeout = latencyModeIdleTimeout->unsigned32BitValue();
+
+    OSNumber* latencyModeHoldTime = OSDynamicCast(OSNumber, getProperty("LatencyModeHoldTime"));
+
+    if (latencyModeHoldTime != NULL)
+        latency_hold_time = latencyModeHoldTime->unsigned32BitValue();
+
+    if (!digitiser.latency_mode || !latency_switching)
+        return true;
+
+    IOWorkLoop* work_loop = getWorkLoop();
+
+    latency_timer = IOTimerEventSource::timerEventSource(this, OSMemberFunctionCast(IOTimerEventSource::Action, this, &VoodooI2CPrecisionTouchpadHIDEventDriver::latencyModeTimeout));
+
+    if (!work_loop || !latency_timer || work_loop->addEventSource(latency_timer) != kIOReturnSuccess) {
+        IOLog("%s::%s Could not add latency mode timer to work loop\n", getName(), name);
+        OSSafeReleaseNULL(latency_timer);
+        return true;
+    }
+
+    // Devices start out in normal latency mode
+    clock_get_uptime(&latency_mode_since);
+    last_activity = latency_mode_since;
+
+    latency_timer->setTimeoutMS(latency_hold_time > latency_idle_timeout ? latency_hold_time : latency_idle_timeout);
+
+    publishLatencyModeStatistics();
+
     return true;
 }
 
+void VoodooI2CPrecisionTouchpadHIDEventDriver::handleStop(IOService* provider) {
+    if (latency_timer) {
+        latency_timer->cancelTimeout();
+        getWorkLoop()->removeEventSource(latency_timer);
+        OSSafeReleaseNULL(latency_timer);
+    }
+
+    super::handleStop(provider);
+}
+
+void VoodooI2CPrecisionTouchpadHIDEventDriver::latencyModeTimeout(OSObject* owner, IOTimerEventSource* timer) {
+    if (!awake)
+        return;
+
+    if (normal_latency_requested) {
+        normal_latency_requested = false;
+
+        if (high_latency && setLatencyMode(false) != kIOReturnSuccess)
+            return;
+    }
+
+    if (high_latency)
+        return;
+
+    uint64_t now;
+    clock_get_uptime(&now);
+
+    uint64_t idle_ns = 0;
+    uint64_t held_ns = 0;
+    absolutetime_to_nanoseconds(now - last_activity, &idle_ns);
+    absolutetime_to_nanoseconds(now - latency_mode_since, &held_ns);
+
+    uint64_t idle_timeout_ns = latency_idle_timeout * 1000000ULL;
+    uint64_t hold_time_ns = latency_hold_time * 1000000ULL;
+
+    if (idle_ns >= idle_timeout_ns && held_ns >= hold_time_ns) {
+        setLatencyMode(true);
+        return;
+    }
+
+    // Check back once both the idle timeout and the hold time have run out
+    uint64_t remaining_ns = idle_ns < idle_timeout_ns ? idle_timeout_ns - idle_ns : 0;
+
+    if (held_ns < hold_time_ns && hold_time_ns - held_ns > remaining_ns)
+        remaining_ns = hold_time_ns - held_ns;
+
+    timer->setTimeoutMS(static_cast<UInt32>(remaining_ns / 1000000ULL) + 1);
+}
+
+void VoodooI2CPrecisionTouchpadHIDEventDriver::publishLatencyModeStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(5);
+
+    if (!properties)
+        return;
+
+    uint64_t now;
+    clock_get_uptime(&now);
+
+    OSString* mode = OSString::withCString(high_latency ? "High" : "Normal");
+    properties->setObject("Mode", mode);
+    OSSafeReleaseNULL(mode);
+
+    for (int i = 0; i < 2; i++) {
+        uint64_t time_ns;
+        absolutetime_to_nanoseconds(latency_mode_time[i] + ((i == high_latency) ? now - latency_mode_since : 0), &time_ns);
+
+        OSNumber* number = OSNumber::withNumber(time_ns / 1000000ULL, 64);
+        properties->setObject(i ? "Time In High Latency (ms)" : "Time In Normal Latency (ms)", number);
+        OSSafeReleaseNULL(number);
+
+        number = OSNumber::withNumber(latency_transitions[i], 32);
+        properties->setObject(i ? "Transitions To High Latency" : "Transitions To Normal Latency", number);
+        OSSafeReleaseNULL(number);
+    }
+
+    setProperty("Latency Mode", properties);
+    properties->release();
+}
+
+IOReturn VoodooI2CPrecisionTouchpadHIDEventDriver::setDeviceReporting(bool enabled) {
+    if (!digitiser.surface_switch || !digitiser.button_switch)
+        return super::setDeviceReporting(enabled);
+
+    // The Selective Reporting feature report holds the Surface Switch in bit 0 and the Button Switch in bit 1
+    UInt8 value = enabled ? (SELECTIVE_REPORTING_SURFACE | SELECTIVE_REPORTING_BUTTON) : 0x00;
+
+    IOBufferMemoryDescriptor* report = IOBufferMemoryDescriptor::inTaskWithOptions(kernel_task, 0, sizeof(value));
+
+    if (!report)
+        return kIOReturnNoMemory;
+
+    report->writeBytes(0, &value, sizeof(value));
+
+    IOReturn ret = hid_interface->setReport(report, kIOHIDReportTypeFeature, digitiser.surface_switch->getReportID());
+    report->release();
+
+    if (ret == kIOReturnSuccess)
+        digitiser_disable_method = "Selective Reporting";
+
+    return ret;
+}
+
+IOReturn VoodooI2CPrecisionTouchpadHIDEventDriver::setLatencyMode(bool high) {
+    UInt8 value = high ? LATENCY_MODE_HIGH : LATENCY_MODE_NORMAL;
+
+    IOBufferMemoryDescriptor* report = IOBufferMemoryDescriptor::inTaskWithOptions(kernel_task, 0, sizeof(value));
+
+    if (!report)
+        return kIOReturnNoMemory;
+
+    report->writeBytes(0, &value, sizeof(value));
+
+    IOReturn ret = hid_interface->setReport(report, kIOHIDReportTypeFeature, digitiser.latency_mode->getReportID());
+    report->release();
+
+    if (ret != kIOReturnSuccess) {
+        IOLog("%s::%s Could not switch to %s latency mode: 0x%.8x\n", getName(), name, high ? "high" : "normal", ret);
+        return ret;
+    }
+
+    uint64_t now;
+    clock_get_uptime(&now);
+
+    latency_mode_time[high_latency] += now - latency_mode_since;
+    latency_mode_since = now;
+    latency_transitions[high]++;
+    high_latency = high;
+
+    publishLatencyModeStatistics();
+
+    return kIOReturnSuccess;
+}
+
 IOReturn VoodooI2CPrecisionTouchpadHIDEventDriver::setPowerState(unsigned long whichState, IOService* whatDevice) {
     if (whatDevice != this)
         return kIOReturnInvalid;
     if (!whichState) {
-        if (awake)
+        if (awake) {
+            if (latency_timer)
+                latency_timer->cancelTimeout();
+
             awake = false;
+        }
     } else {
         if (!awake) {
             IOSleep(10);
             enterPrecisionTouchpadMode();
 
+            // The device comes back from sleep reporting again
+            if (device_reporting_disabled)
+                setDeviceReporting(false);
+
             awake = true;
+
+            // Start the wake in normal latency mode and let the idle timeout take it from there
+            if (latency_timer) {
+                uint64_t now;
+                clock_get_uptime(&now);
+                last_activity = now;
+
+                normal_latency_requested = true;
+                latency_timer->setTimeoutUS(1);
+            }
         }
     }
     return kIOPMAckImplied;
@@ -13,16 +13,23 @@
 #include <IOKit/IOKitKeys.h>
 #include <IOKit/IOService.h>
 #include <IOKit/IOBufferMemoryDescriptor.h>
+#include <IOKit/IOTimerEventSource.h>
 #include <kern/clock.h>
 
 #include "VoodooI2CMultitouchHIDEventDriver.hpp"
 
-#define kHIDUsage_Dig_Surface_Switch 0x57
-#define kHIDUsage_Dig_Button_Switch 0x58
-
 #define INPUT_MODE_MOUSE 0x00
 #define INPUT_MODE_TOUCHPAD 0x03
 
+#define SELECTIVE_REPORTING_SURFACE 0x01
+#define SELECTIVE_REPORTING_BUTTON  0x02
+
+#define LATENCY_MODE_NORMAL 0x00
+#define LATENCY_MODE_HIGH   0x01
+
+#define LATENCY_MODE_DEFAULT_IDLE_TIMEOUT 1000     // ms
+#define LATENCY_MODE_DEFAULT_HOLD_TIME    3000     // ms
+
 typedef struct __attribute__((__packed__)) {
     UInt8 value;
     UInt8 reserved;
@@ -45,15 +52,68 @@ class EXPORT VoodooI2CPrecisionTouchpadHIDEventDriver : public VoodooI2CMultitou
 
     bool handleStart(IOService* provider);
 
+    /* @inherit */
+
+    void handleStop(IOService* provider);
+
     /* @inherit */
     IOReturn setPowerState(unsigned long whichState, IOService* whatDevice);
 
  protected:
+    /* Turns the Surface Switch and Button Switch of the device off or back on, falling back to HID sleep without them
+     * @enabled *true* to resume reporting, *false* to stop it
+     *
+     * @return *kIOReturnSuccess* if the device changed its reporting, an error otherwise
+     */
+
+    IOReturn setDeviceReporting(bool enabled) override;
+
  private:
     bool ready = false;
 
     /* Sends a report to the device to instruct it to enter Touchpad mode */
     void enterPrecisionTouchpadMode();
+
+    /* Latency mode policy
+     *
+     * Devices that declare the Latency Mode feature are put into high latency mode, in which they scan less often, once
+     * no contact has been reported for <latency_idle_timeout> ms. The first report after that switches them back to
+     * normal latency, where they then stay for at least <latency_hold_time> ms so that the mode does not flap while the
+     * user pauses between gestures.
+     */
+
+    IOTimerEventSource* latency_timer = NULL;
+
+    bool latency_switching = true;
+    UInt32 latency_idle_timeout = LATENCY_MODE_DEFAULT_IDLE_TIMEOUT;
+    UInt32 latency_hold_time = LATENCY_MODE_DEFAULT_HOLD_TIME;
+
+    bool high_latency = false;
+    volatile bool normal_latency_requested = false;
+    volatile AbsoluteTime last_activity = 0;
+    AbsoluteTime latency_mode_since = 0;
+
+    UInt32 latency_transitions[2] = {};         // Indexed by the mode switched to
+    AbsoluteTime latency_mode_time[2] = {};     // Indexed by the mode
+
+    /* Called by the latency timer to move between latency modes
+     * @owner The owner of the timer event source
+     * @timer The timer event source
+     */
+
+    void latencyModeTimeout(OSObject* owner, IOTimerEventSource* timer);
+
+    /* Publishes the latency mode, its transition counts and the time spent in either mode to the IOService plane */
+
+    void publishLatencyModeStatistics();
+
+    /* Sends a report to the device to switch its latency mode
+     * @high *true* for high latency mode, *false* for normal latency mode
+     *
+     * @return *kIOReturnSuccess* on success, an error otherwise
+     */
+
+    IOReturn setLatencyMode(bool high);
 };
 
 
@@ -26,7 +26,6 @@ void VoodooI2CStylusHIDEventDriver::handleInterruptReport(AbsoluteTime timestamp
     
     digitiser.current_report = 1;
     digitiser.current_contact_count = 1;
-    digitiser.report_count = 1;
     
     handleDigitizerReport(timestamp, report_id);
     
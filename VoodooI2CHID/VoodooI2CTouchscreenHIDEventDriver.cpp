@@ -14,60 +14,56 @@ OSDefineMetaClassAndStructors(VoodooI2CTouchscreenHIDEventDriver, VoodooI2CMulti
 
 // Override of VoodooI2CMultitouchHIDEventDriver
 
+void VoodooI2CTouchscreenHIDEventDriver::bindDisplay() {
+    display_transform* transform = getDisplayTransform(display_binding.getFramebuffer());
+
+    if (transform == active_transform)
+        return;
+
+    if (display_binding.getFramebuffer())
+        IOLog("%s::Got active framebuffer\n", getName());
+
+    active_transform = transform;
+
+    if (multitouch_interface)
+        multitouch_interface->setProperty(kIOFBTransformKey, transform->rotation, 8);
+}
+
 bool VoodooI2CTouchscreenHIDEventDriver::checkFingerTouch(AbsoluteTime timestamp, VoodooI2CMultitouchEvent event) {
     bool got_transducer = false;
     
     // If there is a finger touch event, decide if it is single or multitouch.
     
-    for (int index = 0; index < digitiser.contact_count->getValue() + 1; index++) {
+    for (int index = 0; index < event.contact_count + 1; index++) {
         VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(index));
         
         if (!transducer)
             return false;
         
-        if (transducer->type == kDigitiserTransducerFinger && digitiser.contact_count->getValue() >= 2) {
+        if (transducer->type == kDigitiserTransducerFinger && event.contact_count >= 2) {
             // Our finger event is multitouch reset clicktick and wait to be dispatched to the multitouch engines.
             
             click_tick = 0;
+            long_press.reset();
         }
         
         if (transducer->type == kDigitiserTransducerFinger && transducer->tip_switch.value()) {
             got_transducer = true;
             // Convert logical coordinates to IOFixed and Scaled;
             
-            IOFixed x = ((transducer->coordinates.x.value() * 1.0f) / transducer->logical_max_x) * 65535;
-            IOFixed y = ((transducer->coordinates.y.value() * 1.0f) / transducer->logical_max_y) * 65535;
+            IOFixed x, y;
+            active_transform->finger.apply(transducer->coordinates.x.value(), transducer->coordinates.y.value(), &x, &y);
             
-            checkRotation(&x, &y);
-            
-            // Track last ID and coordinates so that we can send the finger lift event after our watch dog timeout.
+            // Track last ID and coordinates so that we can send the finger lift event once the touch ends.
             last_x = x;
             last_y = y;
             last_id = transducer->secondary_id;
             
-            // Begin long press right click routine.  Increasing compare_input_counter check will lengthen the time until execution.
+            // Begin long press right click routine.  The duration and radius are set through LongPressDuration and LongPressRadius.
             
-            UInt16 temp_x = x;
-            UInt16 temp_y = y;
+            if (!right_click && event.contact_count == 1 && long_press.update(x, y, timestamp))
+                right_click = true;
             
-            if (!right_click && digitiser.contact_count->getValue() == 1 && transducer->type == kDigitiserTransducerFinger && transducer->tip_switch) {
-                if (temp_x == compare_input_x && temp_y == compare_input_y) {
-                    compare_input_counter = compare_input_counter + 1;
-                    compare_input_x = temp_x;
-                    compare_input_y = temp_y;
-                    
-                    if (compare_input_counter >= 120 && !right_click) {
-                        compare_input_x = 0;
-                        compare_input_y = 0;
-                        compare_input_counter = 0;
-                        right_click = true;
-                    }
-                } else {
-                    compare_input_x = temp_x;
-                    compare_input_y = temp_y;
-                    compare_input_counter = 0;
-                }
-            }
             //  End long press right click routine.
             
             
@@ -86,31 +82,11 @@ bool VoodooI2CTouchscreenHIDEventDriver::checkFingerTouch(AbsoluteTime timestamp
                 buttons = 0x2;
             
             dispatchDigitizerEventWithTiltOrientation(timestamp, transducer->secondary_id, transducer->type, 0x1, buttons, x, y);
-            
-            //  This timer serves to let us know when a finger based event is finished executing as well as let us
-            // know to reset the clicktick counter.
-            
-            
-            this->timer_source->setTimeoutMS(14);
         }
     }
     return got_transducer;
 }
 
-void VoodooI2CTouchscreenHIDEventDriver::checkRotation(IOFixed* x, IOFixed* y) {
-    if (active_framebuffer) {
-        if (current_rotation & kIOFBSwapAxes) {
-            IOFixed old_x = *x;
-            *x = *y;
-            *y = old_x;
-        }
-        if (current_rotation & kIOFBInvertX)
-            *x = 65535 - *x;
-        if (current_rotation & kIOFBInvertY)
-            *y = 65535 - *y;
-    }
-}
-
 bool VoodooI2CTouchscreenHIDEventDriver::checkStylus(AbsoluteTime timestamp, VoodooI2CMultitouchEvent event) {
     //  Check the current transducers for stylus operation, dispatch the pointer events and return true.
     //  At this time, Apple has removed all methods of handling additional information from the event driver.  Only x, y, buttonstate, and
@@ -119,29 +95,26 @@ bool VoodooI2CTouchscreenHIDEventDriver::checkStylus(AbsoluteTime timestamp, Voo
     for (int index = 0, count = event.transducers->getCount(); index < count; index++) {
         VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(index));
 
+        if (transducer->type == kDigitiserTransducerStylus && !transducer->in_range) {
+            stylus_button_state.reset();
+
+            // The pen left, the next hover starts from wherever it comes back
+            if (hover_coalescer.isTracking())
+                hover_coalescer.reset();
+        }
+
         if (transducer->type == kDigitiserTransducerStylus && transducer->in_range) {
             VoodooI2CDigitiserStylus* stylus = (VoodooI2CDigitiserStylus*)transducer;
-            IOFixed x = ((stylus->coordinates.x.value() * 1.0f) / stylus->logical_max_x) * 65535;
-            IOFixed y = ((stylus->coordinates.y.value() * 1.0f) / stylus->logical_max_y) * 65535;
-            IOFixed z = ((stylus->coordinates.z.value() * 1.0f) / stylus->logical_max_z) * 65535;
-            IOFixed stylus_pressure = ((stylus->tip_pressure.value() * 1.0f) /stylus->pressure_physical_max) * 65535;
-            
-            checkRotation(&x, &y);
-            
-            if (stylus->barrel_switch.value() != 0x0 && stylus->barrel_switch.value() !=0x2 && (stylus->barrel_switch.value()-barrel_switch_offset) != 0x2)
-                barrel_switch_offset = stylus->barrel_switch.value();
-            if (stylus->eraser.value() != 0x0 && stylus->eraser.value() !=0x2 && (stylus->eraser.value()-eraser_switch_offset) != 0x4)
-                eraser_switch_offset = stylus->eraser.value();
+            IOFixed x, y;
+            active_transform->stylus.apply(stylus->coordinates.x.value(), stylus->coordinates.y.value(), &x, &y);
+            IOFixed z = VoodooI2CHIDCoordinateTransform::scale(stylus->coordinates.z.value(), stylus->logical_max_z);
+            IOFixed stylus_pressure = pressure_curve.apply(VoodooI2CHIDCoordinateTransform::scale(stylus->tip_pressure.value(), stylus->pressure_physical_max));
             
-            stylus_buttons = stylus->tip_switch.value();
+            stylus_buttons = stylus_button_state.update(stylus->tip_switch.value(), stylus->barrel_switch.value(), stylus->eraser.value(), stylus->invert, timestamp);
             
-            if (stylus->barrel_switch.value() == 0x2 || (stylus->barrel_switch.value() - barrel_switch_offset) == 0x2) {
-                stylus_buttons = 0x2;
-            }
-            
-            if (stylus->eraser.value() == 0x4 || (stylus->eraser.value() - eraser_switch_offset) == 0x4) {
-                stylus_buttons = 0x4;
-            }
+            // Hovering pens report far more often than the pointer needs to move
+            if (!hover_coalescer.shouldDispatch(stylus_buttons, x, y, stylus->tilt_orientation.x_tilt.value(), stylus->tilt_orientation.y_tilt.value()))
+                return true;
             
             dispatchDigitizerEventWithTiltOrientation(timestamp, stylus->secondary_id, stylus->type, stylus->in_range, stylus_buttons, x, y, z, stylus_pressure, stylus->barrel_pressure.value(), stylus->azi_alti_orientation.twist.value(), stylus->tilt_orientation.x_tilt.value(), stylus->tilt_orientation.y_tilt.value());
             
@@ -152,95 +125,191 @@ bool VoodooI2CTouchscreenHIDEventDriver::checkStylus(AbsoluteTime timestamp, Voo
     return false;
 }
 
+bool VoodooI2CTouchscreenHIDEventDriver::configurePressureCurve(OSArray* points) {
+    if (!command_gate)
+        return configurePressureCurveGated(points) == kIOReturnSuccess;
+
+    return command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CTouchscreenHIDEventDriver::configurePressureCurveGated), points) == kIOReturnSuccess;
+}
+
+IOReturn VoodooI2CTouchscreenHIDEventDriver::configurePressureCurveGated(OSArray* points) {
+    UInt16 inputs[PRESSURE_CURVE_MAX_POINTS];
+    UInt16 outputs[PRESSURE_CURVE_MAX_POINTS];
+    UInt8 count = 0;
+
+    if (points->getCount() > PRESSURE_CURVE_MAX_POINTS)
+        return kIOReturnBadArgument;
+
+    for (int i = 0; i < points->getCount(); i++) {
+        OSDictionary* point = OSDynamicCast(OSDictionary, points->getObject(i));
+
+        if (!point)
+            return kIOReturnBadArgument;
+
+        OSNumber* input = OSDynamicCast(OSNumber, point->getObject("Input"));
+        OSNumber* output = OSDynamicCast(OSNumber, point->getObject("Output"));
+
+        if (!input || !output)
+            return kIOReturnBadArgument;
+
+        inputs[count] = input->unsigned16BitValue();
+        outputs[count++] = output->unsigned16BitValue();
+    }
+
+    return pressure_curve.configure(inputs, outputs, count) ? kIOReturnSuccess : kIOReturnBadArgument;
+}
+
+void VoodooI2CTouchscreenHIDEventDriver::endGesture(AbsoluteTime timestamp) {
+    UInt8 count = gesture_recognizer.end(timestamp, gesture_events);
+
+    for (int i = 0; i < count; i++)
+        handleGestureEvent(gesture_events[i]);
+
+    gesture_active = false;
+    scroll_residual_x = 0;
+    scroll_residual_y = 0;
+}
+
 void VoodooI2CTouchscreenHIDEventDriver::fingerLift() {
-    //  Here we execute a single touch pointer lift event.  Finger based digitizer events have no in_range
-    // component.  Greater accuracy / error rejection is achieved by filtering by tip_switch vs transducer id in the
-    //  checkFingerTouch function, however, this has the side effect of not releasing the pointer.  This watchdog
-    //  timer is needed regardless so the pointer release is best done here.
-    
-    
-    click_tick = 0;
-    start_scroll = true;
+    //  Finger based digitizer events have no in_range component, a touch ends with a frame in which no finger has its
+    //  tip switch set. Some firmware never sends that frame, this watchdog releases the pointer for them.
+
+    watchdog_armed = false;
+
+    if (!touch_active)
+        return;
+
     uint64_t now_abs;
     clock_get_uptime(&now_abs);
-    
-    dispatchDigitizerEventWithTiltOrientation(now_abs, last_id, kDigitiserTransducerFinger, 0x1, 0x0, last_x, last_y);
-    
-    
-    //  If a right click has been executed, we reset our counter and ensure that pointer is not stuck in right
-    //  click button down situation.
-    
-    if (right_click) {
-        right_click = false;
-    }
-}
 
-IOFramebuffer* VoodooI2CTouchscreenHIDEventDriver::getFramebuffer() {
-    IORegistryEntry* display = NULL;
-    IOFramebuffer* framebuffer = NULL;
-    
-    OSDictionary *match = serviceMatching("IODisplay");
-    OSIterator *iterator = getMatchingServices(match);
+    uint64_t idle_ns;
+    absolutetime_to_nanoseconds(now_abs - last_touch_time, &idle_ns);
 
-    if (iterator) {
-        display = OSDynamicCast(IORegistryEntry, iterator->getNextObject());
-        
-        if (display) {
-            IOLog("%s::Got active display\n", getName());
-            IORegistryEntry *entry = display->getParentEntry(gIOServicePlane)->getParentEntry(gIOServicePlane);
-            if (entry)
-                framebuffer = reinterpret_cast<IOFramebuffer*>(entry->metaCast("IOFramebuffer"));
-            if (framebuffer)
-                IOLog("%s::Got active framebuffer\n", getName());
-        }
-        
-        iterator->release();
+    // Frames keep arriving, check back once the last one is a watchdog period old
+    if (idle_ns < FINGER_LIFT_WATCHDOG_MS * 1000000ULL) {
+        watchdog_armed = true;
+        timer_source->setTimeoutMS(FINGER_LIFT_WATCHDOG_MS - static_cast<UInt32>(idle_ns / 1000000ULL));
+        return;
     }
-    
-    OSSafeReleaseNULL(match);
 
-    return framebuffer;
+    releaseFinger(last_touch_time, true);
 }
 
 void VoodooI2CTouchscreenHIDEventDriver::forwardReport(VoodooI2CMultitouchEvent event, AbsoluteTime timestamp) {
-    if (!active_framebuffer)
-        active_framebuffer = getFramebuffer();
+    if (!event.contact_count) {
+        // Every contact has left the screen
+        if (touch_active)
+            releaseFinger(timestamp, false);
 
-    if (active_framebuffer) {
-        OSNumber* number = OSDynamicCast(OSNumber, active_framebuffer->getProperty(kIOFBTransformKey));
-        current_rotation = number->unsigned8BitValue() / 0x10;
-        multitouch_interface->setProperty(kIOFBTransformKey, current_rotation, 8);
+        return;
     }
-    
-    if (event.contact_count) {
-        event.contact_count = digitiser.contact_count->getValue();
-        event.transducers = digitiser.transducers;
 
-        // Send multitouch information to the multitouch interface
-    
-        if (!event.contact_count)
-            return;
-    
-        if (event.contact_count > 5) {
-            return;
-        }
+    // Keep the contact count the pipeline assembled, the Contact Count element only holds that of the last report
+    event.transducers = digitiser.transducers;
 
-        if (event.contact_count >= 2) {
-            if (event.contact_count == 2 && start_scroll) {
-                scrollPosition(timestamp, event);
-            } else if (event.contact_count == 2 && !start_scroll) {
-                this->timer_source->setTimeoutMS(14);
-            }
+    // Send multitouch information to the multitouch interface
+
+    // Palms on 10-point panels easily exceed what the gesture engines handle, keep the best contacts instead of the frame
+    if (contact_selector.needsSelection(event))
+        contact_selector.select(event, forwarded_transducers);
+
+    bool gesture = false;
 
+    if (gestures_enabled && event.contact_count == 2)
+        gesture = recognizeGesture(timestamp, event);
+    else if (gesture_active)
+        endGesture(timestamp);
+
+    if (gesture) {
+        // Two finger pans are scrolled here, everything else two fingers do is left to the multitouch engine
+    } else if (event.contact_count >= 2) {
+        if (event.contact_count == 2 && start_scroll)
+            scrollPosition(timestamp, event);
+
+        multitouch_interface->handleInterruptReport(event, timestamp);
+    } else {
+        // Process single touch data
+        if (checkStylus(timestamp, event))
+            return;
+
+        if (!checkFingerTouch(timestamp, event))
             multitouch_interface->handleInterruptReport(event, timestamp);
-        } else {
-            // Process single touch data
-            if (!checkStylus(timestamp, event)) {
-                if (!checkFingerTouch(timestamp, event))
-                    multitouch_interface->handleInterruptReport(event, timestamp);
-            }
-        }
     }
+
+    // The last finger lifting ends the touch right away, the watchdog only covers firmware that never reports it
+    UInt32 touching = 0;
+
+    for (int index = 0, count = event.transducers->getCount(); index < count && index < event.contact_count; index++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(index));
+
+        if (transducer && transducer->type == kDigitiserTransducerFinger && transducer->tip_switch.value())
+            touching |= 1U << (transducer->secondary_id & 31);
+    }
+
+    // Remember which contacts the engines know about for the next frame that needs narrowing
+    contact_selector.forwarded_identifiers = touching;
+
+    if (touching)
+        noteTouch(timestamp);
+    else if (touch_active)
+        releaseFinger(timestamp, false);
+}
+
+VoodooI2CTouchscreenHIDEventDriver::display_transform* VoodooI2CTouchscreenHIDEventDriver::getDisplayTransform(IOFramebuffer* framebuffer) {
+    if (!framebuffer)
+        return &unbound_transform;
+
+    display_transform* transform = NULL;
+
+    for (int i = 0; i < DISPLAY_TRANSFORM_CACHE_SIZE; i++) {
+        if (display_transforms[i].framebuffer != framebuffer)
+            continue;
+
+        if (display_transforms[i].valid)
+            return &display_transforms[i];
+
+        // Stale entries are rebuilt in another slot so that the active transform is never rewritten in place
+        display_transforms[i].framebuffer = NULL;
+        break;
+    }
+
+    do {
+        transform = &display_transforms[next_display_transform];
+        next_display_transform = (next_display_transform + 1) % DISPLAY_TRANSFORM_CACHE_SIZE;
+    } while (transform == active_transform);
+
+    OSNumber* number = OSDynamicCast(OSNumber, framebuffer->getProperty(kIOFBTransformKey));
+
+    transform->framebuffer = framebuffer;
+    transform->rotation = number ? number->unsigned8BitValue() / 0x10 : 0;
+    transform->finger = unbound_transform.finger;
+    transform->stylus = unbound_transform.stylus;
+    transform->finger.setRotation(transform->rotation);
+    transform->stylus.setRotation(transform->rotation);
+    transform->valid = true;
+
+    return transform;
+}
+
+void VoodooI2CTouchscreenHIDEventDriver::handleGestureEvent(const VoodooI2CHIDGestureEvent& event) {
+    if (event.type != kVoodooI2CHIDGesturePan || event.phase == kVoodooI2CHIDGestureEnded)
+        return;
+
+    // Scroll whole lines and carry the remainder over so that slow pans still scroll
+    scroll_residual_x += event.delta_x;
+    scroll_residual_y += event.delta_y;
+
+    SInt32 lines_x = scroll_residual_x / TOUCHSCREEN_GESTURE_SCROLL_UNIT;
+    SInt32 lines_y = scroll_residual_y / TOUCHSCREEN_GESTURE_SCROLL_UNIT;
+
+    if (!lines_x && !lines_y)
+        return;
+
+    scroll_residual_x -= lines_x * TOUCHSCREEN_GESTURE_SCROLL_UNIT;
+    scroll_residual_y -= lines_y * TOUCHSCREEN_GESTURE_SCROLL_UNIT;
+
+    // The content follows the fingers
+    dispatchScrollWheelEvent(event.timestamp, lines_y, lines_x, 0);
 }
 
 bool VoodooI2CTouchscreenHIDEventDriver::handleStart(IOService* provider) {
@@ -263,22 +332,379 @@ bool VoodooI2CTouchscreenHIDEventDriver::handleStart(IOService* provider) {
         return false;
     }
     
-    active_framebuffer = getFramebuffer();
+    // Map every transducer type from its own logical range, taken from the descriptor since no report has been decoded yet
+    for (int i = 0; digitiser.transducers && i < digitiser.transducers->getCount(); i++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, digitiser.transducers->getObject(i));
+
+        if (!transducer)
+            continue;
+
+        VoodooI2CHIDCoordinateTransform& transform = transducer->type == kDigitiserTransducerStylus ? unbound_transform.stylus : unbound_transform.finger;
+
+        if (!transform.configure(transducer->collection))
+            IOLog("%s::Transducer %d has no logical range for X and Y\n", getName(), i);
+    }
+
+    active_transform = &unbound_transform;
+
+    // Forward every contact the digitiser can report, up to what the gesture engines handle
+    UInt32 contact_count_maximum = digitiser.contact_count_maximum ? getElementValue(digitiser.contact_count_maximum) : 0;
+
+    if (contact_count_maximum)
+        contact_selector.max_contacts = contact_count_maximum < CONTACT_SELECTOR_MAX_CONTACTS ? contact_count_maximum : CONTACT_SELECTOR_MAX_CONTACTS;
+
+    // Read contact limit configuration value (if available)
+    OSNumber* maxContacts = OSDynamicCast(OSNumber, getProperty("TouchscreenMaxContacts"));
+
+    if (maxContacts != NULL && maxContacts->unsigned8BitValue() >= 2 && maxContacts->unsigned8BitValue() <= CONTACT_SELECTOR_MAX_CONTACTS)
+        contact_selector.max_contacts = maxContacts->unsigned8BitValue();
+
+    forwarded_transducers = OSArray::withCapacity(contact_selector.max_contacts);
+
+    if (!forwarded_transducers)
+        return false;
+
+    // Read gesture configuration value (if available)
+    OSBoolean* touchscreenGestures = OSDynamicCast(OSBoolean, getProperty("TouchscreenGestures"));
+
+    if (touchscreenGestures != NULL)
+        gestures_enabled = touchscreenGestures->isTrue();
+
+    // Read stylus button configuration value (if available)
+    UInt32 stylus_button_debounce = STYLUS_BUTTON_DEFAULT_DEBOUNCE;
+
+    OSNumber* stylusButtonDebounce = OSDynamicCast(OSNumber, getProperty("StylusButtonDebounce"));
+
+    if (stylusButtonDebounce != NULL)
+        stylus_button_debounce = stylusButtonDebounce->unsigned32BitValue();
+
+    stylus_button_state.configure(stylus_button_debounce);
+
+    // Read hover coalescing configuration values (if available)
+    OSBoolean* stylusHoverCoalescing = OSDynamicCast(OSBoolean, getProperty("StylusHoverCoalescing"));
+
+    if (stylusHoverCoalescing != NULL)
+        hover_coalescer.enabled = stylusHoverCoalescing->isTrue();
+
+    OSNumber* stylusHoverThreshold = OSDynamicCast(OSNumber, getProperty("StylusHoverThreshold"));
+
+    if (stylusHoverThreshold != NULL)
+        hover_coalescer.threshold = stylusHoverThreshold->unsigned32BitValue();
+
+    // Read pressure curve configuration value (if available)
+    OSArray* pressureCurve = OSDynamicCast(OSArray, getProperty("PressureCurve"));
+
+    if (pressureCurve != NULL && !configurePressureCurve(pressureCurve))
+        IOLog("%s::Invalid pressure curve, using a linear one\n", getName());
+
+    // Read long press configuration values (if available)
+    UInt32 long_press_duration = LONG_PRESS_DEFAULT_DURATION;
+    UInt32 long_press_radius = LONG_PRESS_DEFAULT_RADIUS;
+
+    OSNumber* longPressDuration = OSDynamicCast(OSNumber, getProperty("LongPressDuration"));
+
+    if (longPressDuration != NULL && longPressDuration->unsigned32BitValue())
+        long_press_duration = longPressDuration->unsigned32BitValue();
+
+    OSNumber* longPressRadius = OSDynamicCast(OSNumber, getProperty("LongPressRadius"));
+
+    if (longPressRadius != NULL && longPressRadius->unsigned32BitValue() <= 1000)
+        long_press_radius = longPressRadius->unsigned32BitValue();
+
+    long_press.configure(long_press_duration, long_press_radius);
+
+    publishLiftStatistics();
+    publishGestureStatistics();
+    publishHoverStatistics();
+
+    display_binding.configure(OSDynamicCast(OSDictionary, getProperty(kDisplayBindingKey)));
+
+    framebuffer_notify = IOFramebuffer::addFramebufferNotification(OSMemberFunctionCast(IOFramebufferNotificationHandler, this, &VoodooI2CTouchscreenHIDEventDriver::notificationFramebufferHandler), this, NULL);
+
+    // Displays that are already published are delivered right away
+    OSDictionary* matching = serviceMatching("IODisplay");
+
+    if (matching) {
+        IOServiceMatchingNotificationHandler handler = OSMemberFunctionCast(IOServiceMatchingNotificationHandler, this, &VoodooI2CTouchscreenHIDEventDriver::notificationDisplayHandler);
+
+        display_publish_notify = addMatchingNotification(gIOFirstPublishNotification, matching, handler, this, NULL);
+        display_terminate_notify = addMatchingNotification(gIOTerminatedNotification, matching, handler, this, NULL);
+        OSSafeReleaseNULL(matching);
+    }
     
     return true;
 }
 
 void VoodooI2CTouchscreenHIDEventDriver::handleStop(IOService* provider) {
+    if (display_publish_notify) {
+        display_publish_notify->remove();
+        display_publish_notify = NULL;
+    }
+
+    if (display_terminate_notify) {
+        display_terminate_notify->remove();
+        display_terminate_notify = NULL;
+    }
+
+    if (framebuffer_notify) {
+        framebuffer_notify->remove();
+        framebuffer_notify = NULL;
+    }
+
+    active_transform = &unbound_transform;
+    display_binding.reset();
+
     if (timer_source) {
+        timer_source->cancelTimeout();
         work_loop->removeEventSource(timer_source);
         OSSafeReleaseNULL(timer_source);
     }
     
     OSSafeReleaseNULL(work_loop);
+    OSSafeReleaseNULL(forwarded_transducers);
     
     super::handleStop(provider);
 }
 
+bool VoodooI2CTouchscreenHIDEventDriver::notificationDisplayHandler(void* refCon, IOService* newService, IONotifier* notifier) {
+    command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CTouchscreenHIDEventDriver::notificationDisplayHandlerGated), newService, notifier);
+
+    return true;
+}
+
+IOReturn VoodooI2CTouchscreenHIDEventDriver::notificationDisplayHandlerGated(IOService* newService, IONotifier* notifier) {
+    if (notifier == display_terminate_notify) {
+        if (!display_binding.release(newService))
+            return kIOReturnSuccess;
+
+        display_binding.rescan();
+    } else if (!display_binding.offer(newService)) {
+        return kIOReturnSuccess;
+    }
+
+    bindDisplay();
+
+    return kIOReturnSuccess;
+}
+
+IOReturn VoodooI2CTouchscreenHIDEventDriver::notificationFramebufferHandler(void* ref, IOFramebuffer* framebuffer, IOIndex event, void* info) {
+    if (event != kIOFBNotifyDisplayModeDidChange)
+        return kIOReturnSuccess;
+
+    return command_gate->runAction(OSMemberFunctionCast(IOCommandGate::Action, this, &VoodooI2CTouchscreenHIDEventDriver::notificationFramebufferHandlerGated), framebuffer);
+}
+
+IOReturn VoodooI2CTouchscreenHIDEventDriver::notificationFramebufferHandlerGated(IOFramebuffer* framebuffer) {
+    // Rotating a display changes its mode, whatever is cached for it is stale now
+    for (int i = 0; i < DISPLAY_TRANSFORM_CACHE_SIZE; i++) {
+        if (display_transforms[i].framebuffer == framebuffer)
+            display_transforms[i].valid = false;
+    }
+
+    if (framebuffer == display_binding.getFramebuffer())
+        bindDisplay();
+
+    return kIOReturnSuccess;
+}
+
+void VoodooI2CTouchscreenHIDEventDriver::noteTouch(AbsoluteTime timestamp) {
+    touch_active = true;
+    last_touch_time = timestamp;
+
+    // Arm the watchdog once per touch rather than reprogramming the timer with every frame
+    if (!watchdog_armed) {
+        watchdog_armed = true;
+        timer_source->setTimeoutMS(FINGER_LIFT_WATCHDOG_MS);
+    }
+}
+
+void VoodooI2CTouchscreenHIDEventDriver::publishGestureStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(3);
+
+    if (!properties)
+        return;
+
+    OSNumber* number = OSNumber::withNumber(gesture_recognizer.recognised[kVoodooI2CHIDGesturePan], 32);
+    properties->setObject("Pans", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(gesture_recognizer.recognised[kVoodooI2CHIDGesturePinch], 32);
+    properties->setObject("Pinches", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(gesture_recognizer.recognised[kVoodooI2CHIDGestureRotate], 32);
+    properties->setObject("Rotations", number);
+    OSSafeReleaseNULL(number);
+
+    setProperty("Gestures", properties);
+    properties->release();
+}
+
+void VoodooI2CTouchscreenHIDEventDriver::publishHoverStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(1);
+
+    if (!properties)
+        return;
+
+    OSNumber* number = OSNumber::withNumber(hover_coalescer.suppressed_events, 32);
+    properties->setObject("Suppressed Events", number);
+    OSSafeReleaseNULL(number);
+
+    setProperty("Hover Coalescing", properties);
+    properties->release();
+}
+
+void VoodooI2CTouchscreenHIDEventDriver::publishLiftStatistics() {
+    OSDictionary* properties = OSDictionary::withCapacity(4);
+
+    if (!properties)
+        return;
+
+    UInt32 lifts = reported_lifts + watchdog_lifts;
+
+    OSNumber* number = OSNumber::withNumber(reported_lifts, 32);
+    properties->setObject("Reported Lifts", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(watchdog_lifts, 32);
+    properties->setObject("Watchdog Lifts", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(lifts ? total_lift_latency_us / lifts : 0, 32);
+    properties->setObject("Average Lift Latency (us)", number);
+    OSSafeReleaseNULL(number);
+
+    number = OSNumber::withNumber(maximum_lift_latency_us, 32);
+    properties->setObject("Maximum Lift Latency (us)", number);
+    OSSafeReleaseNULL(number);
+
+    setProperty("Finger Lift", properties);
+    properties->release();
+}
+
+bool VoodooI2CTouchscreenHIDEventDriver::recognizeGesture(AbsoluteTime timestamp, VoodooI2CMultitouchEvent event) {
+    VoodooI2CDigitiserTransducer* fingers[2];
+    int finger_count = 0;
+
+    for (int index = 0, count = event.transducers->getCount(); index < count && index < event.contact_count; index++) {
+        VoodooI2CDigitiserTransducer* transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(index));
+
+        if (!transducer || transducer->type != kDigitiserTransducerFinger || !transducer->tip_switch.value())
+            continue;
+
+        if (finger_count == 2)
+            return false;
+
+        fingers[finger_count++] = transducer;
+    }
+
+    // A lifting finger ends the gesture, what is left is for the engine
+    if (finger_count != 2) {
+        if (gesture_active)
+            endGesture(timestamp);
+
+        return false;
+    }
+
+    IOFixed x_a, y_a, x_b, y_b;
+    active_transform->finger.apply(fingers[0]->coordinates.x.value(), fingers[0]->coordinates.y.value(), &x_a, &y_a);
+    active_transform->finger.apply(fingers[1]->coordinates.x.value(), fingers[1]->coordinates.y.value(), &x_b, &y_b);
+
+    UInt8 count = gesture_recognizer.update(fingers[0]->secondary_id, x_a, y_a, fingers[1]->secondary_id, x_b, y_b, timestamp, gesture_events);
+
+    for (int i = 0; i < count; i++)
+        handleGestureEvent(gesture_events[i]);
+
+    gesture_active = true;
+    click_tick = 0;
+    long_press.reset();
+
+    // Only pans are acted on, the engine still needs the frames of zooms, rotations and taps
+    return gesture_recognizer.isActive(kVoodooI2CHIDGesturePan) && !gesture_recognizer.isActive(kVoodooI2CHIDGesturePinch) && !gesture_recognizer.isActive(kVoodooI2CHIDGestureRotate);
+}
+
+void VoodooI2CTouchscreenHIDEventDriver::releaseFinger(AbsoluteTime lifted_at, bool watchdog) {
+    // The watchdog and a reported lift may both see the same touch end, only the first one releases it
+    if (!touch_active)
+        return;
+
+    uint64_t now_abs;
+    clock_get_uptime(&now_abs);
+
+    if (gesture_active)
+        endGesture(lifted_at);
+
+    touch_active = false;
+    click_tick = 0;
+    start_scroll = true;
+    long_press.reset();
+
+    // A watchdog release happens now, a reported one when the frame showing the lift was scanned
+    dispatchDigitizerEventWithTiltOrientation(watchdog ? now_abs : lifted_at, last_id, kDigitiserTransducerFinger, 0x1, 0x0, last_x, last_y);
+
+    //  If a right click has been executed, we reset our counter and ensure that pointer is not stuck in right
+    //  click button down situation.
+
+    if (right_click) {
+        right_click = false;
+    }
+
+    // Measure how long after the lift the pointer was released
+    uint64_t latency_ns = 0;
+
+    if (now_abs > lifted_at)
+        absolutetime_to_nanoseconds(now_abs - lifted_at, &latency_ns);
+
+    UInt32 latency_us = static_cast<UInt32>(latency_ns / 1000);
+
+    if (watchdog)
+        watchdog_lifts++;
+    else
+        reported_lifts++;
+
+    total_lift_latency_us += latency_us;
+
+    if (latency_us > maximum_lift_latency_us)
+        maximum_lift_latency_us = latency_us;
+}
+
+IOReturn VoodooI2CTouchscreenHIDEventDriver::setProperties(OSObject* properties) {
+    OSDictionary* dict = OSDynamicCast(OSDictionary, properties);
+
+    if (dict != NULL) {
+        OSArray* points = OSDynamicCast(OSArray, dict->getObject("PressureCurve"));
+
+        if (points != NULL) {
+            IOLog("%s::setProperties PressureCurve = %d points\n", getName(), points->getCount());
+
+            // The new curve is compiled under the gate and swapped in between two frames
+            if (configurePressureCurve(points))
+                setProperty("PressureCurve", points);
+            else
+                IOLog("%s::Invalid pressure curve, keeping the current one\n", getName());
+        }
+
+        OSBoolean* coalescing = OSDynamicCast(OSBoolean, dict->getObject("StylusHoverCoalescing"));
+
+        if (coalescing != NULL) {
+            IOLog("%s::setProperties StylusHoverCoalescing = %d\n", getName(), coalescing->isTrue());
+
+            hover_coalescer.enabled = coalescing->isTrue();
+        }
+
+        if (dict->getObject("UpdateFingerLiftStatistics"))
+            publishLiftStatistics();
+
+        if (dict->getObject("UpdateGestureStatistics"))
+            publishGestureStatistics();
+
+        if (dict->getObject("UpdateHoverStatistics"))
+            publishHoverStatistics();
+    }
+
+    return super::setProperties(properties);
+}
+
 void VoodooI2CTouchscreenHIDEventDriver::scrollPosition(AbsoluteTime timestamp, VoodooI2CMultitouchEvent event) {
     if (start_scroll) {
         int index = 0;
@@ -288,19 +714,18 @@ void VoodooI2CTouchscreenHIDEventDriver::scrollPosition(AbsoluteTime timestamp,
             transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(index));
         }
         
-        IOFixed x = ((transducer->coordinates.x.value() * 1.0f) / transducer->logical_max_x) * 65535;
-        IOFixed y = ((transducer->coordinates.y.value() * 1.0f) / transducer->logical_max_y) * 65535;
+        UInt32 x = transducer->coordinates.x.value();
+        UInt32 y = transducer->coordinates.y.value();
         
         index++;
         transducer = OSDynamicCast(VoodooI2CDigitiserTransducer, event.transducers->getObject(index));
         
-        IOFixed x2 = ((transducer->coordinates.x.value() * 1.0f) / transducer->logical_max_x) * 65535;
-        IOFixed y2 = ((transducer->coordinates.y.value() * 1.0f) / transducer->logical_max_y) * 65535;
-        
-        IOFixed cursor_x = (x+x2)/2;
-        IOFixed cursor_y = (y+y2)/2;
+        UInt32 x2 = transducer->coordinates.x.value();
+        UInt32 y2 = transducer->coordinates.y.value();
         
-        checkRotation(&cursor_x, &cursor_y);
+        // The transform is affine so the midpoint can be taken before mapping it
+        IOFixed cursor_x, cursor_y;
+        active_transform->finger.apply((x + x2) / 2, (y + y2) / 2, &cursor_x, &cursor_y);
         
         dispatchDigitizerEventWithTiltOrientation(timestamp, transducer->secondary_id, transducer->type, 0x1, 0x0, cursor_x, cursor_y);
         
@@ -310,6 +735,4 @@ void VoodooI2CTouchscreenHIDEventDriver::scrollPosition(AbsoluteTime timestamp,
         
         start_scroll = false;
     }
-    
-    this->timer_source->setTimeoutMS(14);
 }
@@ -23,6 +23,20 @@
 
 
 #include "VoodooI2CMultitouchHIDEventDriver.hpp"
+#include "VoodooI2CHIDContactSelector.hpp"
+#include "VoodooI2CHIDCoordinateTransform.hpp"
+#include "VoodooI2CHIDDisplayBinding.hpp"
+#include "VoodooI2CHIDGestureRecognizer.hpp"
+#include "VoodooI2CHIDHoverCoalescer.hpp"
+#include "VoodooI2CHIDLongPressRecognizer.hpp"
+#include "VoodooI2CHIDPressureCurve.hpp"
+#include "VoodooI2CHIDStylusButtonStateMachine.hpp"
+
+#define DISPLAY_TRANSFORM_CACHE_SIZE 4
+
+#define FINGER_LIFT_WATCHDOG_MS 250
+
+#define TOUCHSCREEN_GESTURE_SCROLL_UNIT 400     // 0 - 65535 range per scrolled line
 
 /* Implements an HID Event Driver for touchscreen devices as well as stylus input.
  */
@@ -45,6 +59,14 @@ class EXPORT VoodooI2CTouchscreenHIDEventDriver : public VoodooI2CMultitouchHIDE
     
     /* @inherit */
     void handleStop(IOService* provider);
+
+    /* Rebuilds the pressure curve when PressureCurve is set and switches hover coalescing when StylusHoverCoalescing is
+     * set, passes everything else on
+     *
+     * @inherit
+     */
+
+    IOReturn setProperties(OSObject* properties) override;
     
  protected:
     /* The transducer is checked for stylus operation and pointer event dispatched.  x,y,z & pressure information is
@@ -57,22 +79,51 @@ class EXPORT VoodooI2CTouchscreenHIDEventDriver : public VoodooI2CMultitouchHIDE
 
     bool checkStylus(AbsoluteTime timestamp, VoodooI2CMultitouchEvent event);
 
+    /* Acts on a gesture recognised from two fingers. Pans are dispatched as scroll wheel events, pinches and rotations
+     * have no event to be dispatched as from an HID event service and are only counted, their frames go to the
+     * multitouch engine instead.
+     *
+     * @event The gesture event
+     */
+
+    virtual void handleGestureEvent(const VoodooI2CHIDGestureEvent& event);
+
  private:
     IOWorkLoop *work_loop;
     IOTimerEventSource *timer_source;
     
-    IOFramebuffer* active_framebuffer;
-    UInt8 current_rotation;
+    VoodooI2CHIDDisplayBinding display_binding;
+
+    IONotifier* display_publish_notify = NULL;      // Notification when an IODisplay is published
+    IONotifier* display_terminate_notify = NULL;    // Notification when an IODisplay is terminated
+    IONotifier* framebuffer_notify = NULL;          // Notification when a framebuffer changes its display mode
+
+    /* The coordinate transforms for a display, rebuilt once the display changes its mode
+     */
+
+    struct display_transform {
+        IOFramebuffer* framebuffer;     // Only used as a key
+        bool valid;
+        UInt8 rotation;
+        VoodooI2CHIDCoordinateTransform finger;
+        VoodooI2CHIDCoordinateTransform stylus;
+    };
+
+    display_transform display_transforms[DISPLAY_TRANSFORM_CACHE_SIZE];
+    display_transform unbound_transform;        // Used while no display is bound, also the template for the others
+    display_transform* volatile active_transform = &unbound_transform;
+    UInt8 next_display_transform = 0;
     
     /* transducer variables
      */
     
     UInt32 buttons = 0;
     UInt32 stylus_buttons = 0;
+    VoodooI2CHIDStylusButtonStateMachine stylus_button_state;
+    VoodooI2CHIDPressureCurve pressure_curve;
+    VoodooI2CHIDHoverCoalescer hover_coalescer;
     IOFixed last_x = 0;
     IOFixed last_y = 0;
-    UInt32 barrel_switch_offset = 0;
-    UInt32 eraser_switch_offset = 0;
     SInt32 last_id = 0;
     
     /* handler variables
@@ -81,9 +132,35 @@ class EXPORT VoodooI2CTouchscreenHIDEventDriver : public VoodooI2CMultitouchHIDE
     int click_tick = 0;
     bool right_click = false;
     bool start_scroll = true;
-    UInt16 compare_input_x = 0;
-    UInt16 compare_input_y = 0;
-    int compare_input_counter = 0;
+    VoodooI2CHIDLongPressRecognizer long_press;
+
+    /* contact selection variables
+     */
+
+    VoodooI2CHIDContactSelector contact_selector;       // Its limit is narrowed to the Contact Count Maximum
+    OSArray* forwarded_transducers = NULL;
+
+    /* gesture variables
+     */
+
+    bool gestures_enabled = false;
+    bool gesture_active = false;
+    VoodooI2CHIDGestureRecognizer gesture_recognizer;
+    VoodooI2CHIDGestureEvent gesture_events[GESTURE_MAX_EVENTS];
+    SInt32 scroll_residual_x = 0;
+    SInt32 scroll_residual_y = 0;
+
+    /* lift variables
+     */
+
+    bool touch_active = false;
+    bool watchdog_armed = false;
+    AbsoluteTime last_touch_time = 0;
+
+    UInt32 reported_lifts = 0;
+    UInt32 watchdog_lifts = 0;
+    uint64_t total_lift_latency_us = 0;
+    UInt32 maximum_lift_latency_us = 0;
     
     /* The transducer is checked for singletouch finger based operation and the pointer event dispatched. This function
      * also handles a long-press, right-click function.
@@ -94,23 +171,121 @@ class EXPORT VoodooI2CTouchscreenHIDEventDriver : public VoodooI2CMultitouchHIDE
      * @return `true` if we got a finger touch event, `false` otherwise
      */
     bool checkFingerTouch(AbsoluteTime timestamp, VoodooI2CMultitouchEvent event);
-    
-    /* Checks to see if the x and y coordinates need to be modified
-     * to account for a rotation
+
+    /* Compiles the pressure curve from its control points
+     * @points An array of dictionaries with the Input and Output of each point in per mille
      *
-     * @x A pointer to the x coordinate
-     * @y A pointer to the y coordinate
+     * @return *true* if the curve was compiled, *false* if the points are invalid and the previous curve is kept
+     */
+
+    bool configurePressureCurve(OSArray* points);
+
+    /* Gated half of <configurePressureCurve>, rebuilds must not overlap
+     * @points An array of dictionaries with the Input and Output of each point in per mille
      *
+     * @return *kIOReturnSuccess* if the curve was compiled, *kIOReturnBadArgument* if the points are invalid
      */
 
-    void checkRotation(IOFixed* x, IOFixed* y);
+    IOReturn configurePressureCurveGated(OSArray* points);
+
+    /* Ends the gesture that is being recognised
+     * @timestamp The timestamp of the frame that ended it
+     */
+
+    void endGesture(AbsoluteTime timestamp);
     
-    /* This timeout based function executes a singletouch finger based pointer lift event as well as ensures that the pointer is not
-     * stuck in a 'right click' mode after the long-press right-click function has been triggered.
+    /* Watchdog that releases the pointer for firmware that never reports a frame without contacts. Touches normally end
+     * in <forwardReport> as soon as the last finger lifts.
+     *
+     * Runs as a timer action on the work loop, reports are decoded under the command gate of the same loop so the lift
+     * state is never touched by both at once.
      */
     void fingerLift();
+
+    /* Records a frame with at least one finger on the screen and arms the lift watchdog if it is not armed yet
+     * @timestamp The timestamp of the frame
+     */
+
+    void noteTouch(AbsoluteTime timestamp);
+
+    /* Publishes the number of recognised gestures to the IOService plane, on request through the UpdateGestureStatistics
+     * property
+     */
+
+    void publishGestureStatistics();
+
+    /* Publishes the number of dropped stylus hover events to the IOService plane, on request through the
+     * UpdateHoverStatistics property
+     */
+
+    void publishHoverStatistics();
+
+    /* Publishes the lift counts and latencies to the IOService plane, on request through the UpdateFingerLiftStatistics
+     * property since lifts happen far too often to publish every one
+     */
+
+    void publishLiftStatistics();
+
+    /* Feeds a frame with exactly two touching fingers to the gesture recogniser
+     * @timestamp The timestamp of the current event being processed
+     * @event The current event
+     *
+     * @return *true* if the frame is part of a pan and was consumed, *false* if it has to go to the multitouch engine
+     */
+
+    bool recognizeGesture(AbsoluteTime timestamp, VoodooI2CMultitouchEvent event);
+
+    /* Executes a singletouch finger based pointer lift event and ensures that the pointer is not stuck in a 'right click'
+     * mode after the long-press right-click function has been triggered.
+     * @lifted_at The timestamp of the frame that showed the lift, or of the last frame with a contact for the watchdog
+     * @watchdog *true* if the watchdog ended the touch, *false* if the digitiser reported the lift
+     */
+
+    void releaseFinger(AbsoluteTime lifted_at, bool watchdog);
     
-    IOFramebuffer* getFramebuffer();
+    /* Switches the coordinate transforms to the display the touchscreen is bound to and passes its rotation on to the
+     * multitouch interface
+     */
+
+    void bindDisplay();
+
+    /* Looks up the coordinate transforms for a display, building them if they are not cached or stale
+     * @framebuffer The framebuffer driving the display, *NULL* if no display is bound
+     *
+     * @return The coordinate transforms
+     */
+
+    display_transform* getDisplayTransform(IOFramebuffer* framebuffer);
+
+    /* Called by IOFramebuffer when a framebuffer changes its display mode, which includes rotating it
+     * @ref The reference set when registering
+     * @framebuffer The framebuffer
+     * @event The framebuffer event
+     * @info Event specific information
+     */
+
+    IOReturn notificationFramebufferHandler(void* ref, IOFramebuffer* framebuffer, IOIndex event, void* info);
+
+    /* Gated half of <notificationFramebufferHandler>, the display transforms are only touched under the gate
+     * @framebuffer The framebuffer that changed its display mode
+     */
+
+    IOReturn notificationFramebufferHandlerGated(IOFramebuffer* framebuffer);
+
+    /* IOServiceMatchingNotificationHandler to receive notification of published and terminated displays
+     * @refCon reference set when registering
+     * @newService The display
+     * @notifier IONotifier object for the notification registration
+     */
+
+    bool notificationDisplayHandler(void* refCon, IOService* newService, IONotifier* notifier);
+
+    /* Gated half of <notificationDisplayHandler>
+     * @newService The display
+     * @notifier IONotifier object for the notification registration
+     */
+
+    IOReturn notificationDisplayHandlerGated(IOService* newService, IONotifier* notifier);
     
     /* Resets the pointer to the current finger location when scrolling begins
      *